@@ -0,0 +1,76 @@
+#include "boil.h"
+
+//Plateau window below the boil point and the rate it must settle under (1/16 C and 1/256 C per sample)
+static const int16_t kBoilWindow = 2 * 16;
+static const int16_t kBoilRateLimit = 4;  //~0.9 C per minute at one sample per second
+
+//Consecutive settled samples needed before a boil is reported
+static const uint8_t kBoilHoldSamples = 60;
+
+//Detection re-arms once the temperature falls this far below the boil point (1/16 C)
+static const int16_t kBoilRearm = 5 * 16;
+
+static int16_t gBoilPoint = 1600;
+static int16_t gBoilLast = 0;
+static int16_t gBoilRate = 0;  //Filtered heating rate in 1/256 C per sample
+static uint8_t gBoilHold = 0;
+static uint8_t gBoilPrimed = 0;
+static uint8_t gBoilDetected = 0;
+
+void boil_init(uint8_t altitude)
+{
+  //Water boils ~0.33 C lower per 100m (85/16 = 5.3 sixteenths), good to ~1 C up to 6000m
+  gBoilPoint = 100 * 16 - (((uint16_t)altitude * 85) >> 4);
+  gBoilRate = 0;
+  gBoilHold = 0;
+  gBoilPrimed = 0;
+  gBoilDetected = 0;
+}
+
+uint8_t boil_update(int16_t temperature)
+{
+  if (!gBoilPrimed) {
+    gBoilLast = temperature;
+    gBoilPrimed = 1;
+    return 0;
+  }
+
+  //Exponential moving average of the derivative, alpha = 1/16
+  int16_t delta = temperature - gBoilLast;
+  gBoilLast = temperature;
+  if (delta > 127)
+    delta = 127;
+  else if (delta < -127)
+    delta = -127;
+  //Steps round away from zero, a plain shift rounds toward -inf and left a negative rate stuck short of 0
+  int16_t step = delta * 16 - gBoilRate;
+  gBoilRate += step >= 0 ? (step + 15) >> 4 : -((15 - step) >> 4);
+
+  if (gBoilDetected) {
+    if (temperature < gBoilPoint - kBoilRearm) {
+      gBoilDetected = 0;
+      gBoilHold = 0;
+    }
+    return 0;
+  }
+
+  if (temperature >= gBoilPoint - kBoilWindow && gBoilRate < kBoilRateLimit && gBoilRate > -kBoilRateLimit) {
+    if (++gBoilHold >= kBoilHoldSamples) {
+      gBoilDetected = 1;
+      return 1;
+    }
+  } else {
+    gBoilHold = 0;
+  }
+  return 0;
+}
+
+uint8_t boil_detected(void)
+{
+  return gBoilDetected;
+}
+
+int16_t boil_point(void)
+{
+  return gBoilPoint;
+}
@@ -0,0 +1,18 @@
+#ifndef BOILPOWER_BOIL_H_
+#define BOILPOWER_BOIL_H_
+
+#include <stdint.h>
+
+//Restart detection for the boil point at altitude (100m units)
+void boil_init(uint8_t altitude);
+
+//Feed a temperature sample (1/16 degrees C, one per TEMPERATURE_SAMPLE_INTERVAL), returns 1 once when a boil is detected
+uint8_t boil_update(int16_t temperature);
+
+//Returns 1 from detection until the temperature falls well below the boil point
+uint8_t boil_detected(void);
+
+//Boil point in 1/16 degrees C
+int16_t boil_point(void);
+
+#endif
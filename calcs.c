@@ -2,21 +2,54 @@
 
 uint8_t calcs_minimum_sensitivity(uint8_t sensitivity, uint8_t period, uint8_t frequency)
 {
-  uint8_t minimumSensitivity = (uint16_t)period * frequency / 255 / 10;
+  //Rounded up, range = period * frequency / sensitivity / 10 must not exceed 255
+  uint8_t minimumSensitivity = ((uint32_t)period * frequency + 2549) / 2550;
   return sensitivity < minimumSensitivity ? minimumSensitivity : sensitivity;
 }
 
 uint8_t calcs_range(uint8_t period, uint8_t frequency, uint8_t sensitivity)
 {
-  return (uint16_t)period * frequency / sensitivity / 10;
+  uint8_t range = (uint16_t)period * frequency / sensitivity / 10;
+  return range ? range : 1; //Callers divide by the range
 }
 
-uint16_t calcs_pwm_time(uint16_t periodMs, uint8_t value, uint8_t range)
+uint16_t calcs_period_cycles(uint8_t period, uint8_t frequency)
 {
-  return (uint32_t)periodMs * value / range;
+  return (uint16_t)period * frequency / 10;
+}
+
+uint16_t calcs_pwm_cycles(uint16_t periodCycles, uint8_t value, uint8_t range)
+{
+  return (uint32_t)periodCycles * value / range;
+}
+
+uint16_t calcs_gcd(uint16_t a, uint16_t b)
+{
+  while (b) {
+    uint16_t remainder = a % b;
+    a = b;
+    b = remainder;
+  }
+  return a;
 }
 
 uint16_t calcs_pwm_percent(uint8_t value, uint8_t range)
 {
   return (uint32_t)value * 1000 / range;
+}
+
+uint8_t calcs_percent_value(uint8_t percent, uint8_t range)
+{
+  if (percent >= 100)
+    return range;
+  uint8_t value = ((uint16_t)percent * range + 50) / 100;
+  return percent && !value ? 1 : value;
+}
+
+uint8_t calcs_value_percent(uint8_t value, uint8_t range)
+{
+  if (value >= range)
+    return 100;
+  uint8_t percent = ((uint16_t)value * 100 + range / 2) / range;
+  return value && !percent ? 1 : percent;
 }
\ No newline at end of file
@@ -3,16 +3,26 @@
 
 #include <stdint.h>
 
-//Calculates minimum required sensitivity to constrain range < 255
+//Calculates minimum required sensitivity to constrain range <= 255
 uint8_t calcs_minimum_sensitivity(uint8_t sensitivity, uint8_t period, uint8_t frequency);
 
-//Calculates number of encoder increments
+//Calculates number of encoder increments (at least 1)
 uint8_t calcs_range(uint8_t period, uint8_t frequency, uint8_t sensitivity);
 
-//Calculates PWM value as ms
-uint16_t calcs_pwm_time(uint16_t periodMs, uint8_t value, uint8_t range);
+//Calculates period length in mains cycles
+uint16_t calcs_period_cycles(uint8_t period, uint8_t frequency);
+
+//Calculates PWM value as mains cycles
+uint16_t calcs_pwm_cycles(uint16_t periodCycles, uint8_t value, uint8_t range);
+
+//Greatest common divisor (0 only if both are 0)
+uint16_t calcs_gcd(uint16_t a, uint16_t b);
 
 //Calculates PWM value as tenths of percent (ie 31/40 = 775 or 77.5%)
 uint16_t calcs_pwm_percent(uint8_t value, uint8_t range);
 
+//Converts between whole percent and encoder increments (rounded, non-zero stays non-zero)
+uint8_t calcs_percent_value(uint8_t percent, uint8_t range);
+uint8_t calcs_value_percent(uint8_t value, uint8_t range);
+
 #endif
\ No newline at end of file
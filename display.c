@@ -1,104 +1,588 @@
 #include "display.h"
 
-#include <stdlib.h>
 #include <string.h>
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 #include <util/atomic.h> 
 
 #include "hwprofile.h"
 
-//Character definitions (PORT BIT TO SEGMENT MAP: ED.C GBFA)
-static const uint8_t kCharTable[] = { 0xd7, //0
-                                      0x14, //1
-                                      0xcd, //2
-                                      0x5d, //3
-                                      0x1e, //4
-                                      0x5b, //5
-                                      0xdb, //6
-                                      0x15, //7
-                                      0xdf, //8
-                                      0x5f, //9
-                                      0x9f, //A
-                                      0xda, //b
-                                      0xc3, //C (alt. c 0xc8)
-                                      0xdc, //d
-                                      0xcb, //E
-                                      0x8b, //F
-                                      0xd3, //G
-                                      0x9e, //H (alt. h 0x9a)
-                                      0x82, //i
-                                      0xd4, //J
-                                      0x00, //K NOT SUPPORTED
-                                      0xc2, //L
-                                      0x00, //M NOT SUPPORTED
-                                      0x97, //N (alt. n 0x98)
-                                      0xd7, //o (alt. 0 0xd8)
-                                      0x8f, //P
-                                      0x1f, //q
-                                      0x88, //r
-                                      0x5b, //S (dupe of 5)
-                                      0xca, //t
-                                      0xd6, //U (alt. u 0xd0)
-                                      0x00, //V NOT SUPPORTED
-                                      0x00, //W NOT SUPPORTED
-                                      0x00, //X NOT SUPPORTED
-                                      0x5e, //y
-                                      0x00  //Z NOT SUPPORTED
+//Character definitions indexed by ASCII from ' ' to '_', lower case letters use upper case entries
+//(PORT BIT TO SEGMENT MAP: ED.C GBFA)
+static const uint8_t kCharTable[] PROGMEM = {
+  0x00, //Space
+  0x00, //!
+  0x06, //"
+  0x00, //#
+  0x00, //$
+  0x00, //%
+  0x00, //&
+  0x02, //'
+  0xc3, //(
+  0x55, //)
+  0x00, //*
+  0x00, //+
+  0x00, //,
+  0x08, //-
+  0x20, //. (merged into the previous char when possible)
+  0x8c, ///
+  0xd7, //0
+  0x14, //1
+  0xcd, //2
+  0x5d, //3
+  0x1e, //4
+  0x5b, //5
+  0xdb, //6
+  0x15, //7
+  0xdf, //8
+  0x5f, //9
+  0x00, //:
+  0x00, //;
+  0x00, //<
+  0x48, //=
+  0x00, //>
+  0x8d, //?
+  0x00, //@
+  0x9f, //A
+  0xda, //b
+  0xc3, //C (alt. c 0xc8)
+  0xdc, //d
+  0xcb, //E
+  0x8b, //F
+  0xd3, //G
+  0x9e, //H (alt. h 0x9a)
+  0x82, //i
+  0xd4, //J
+  0x9b, //K (approximation)
+  0xc2, //L
+  0x91, //M (approximation)
+  0x97, //N (alt. n 0x98)
+  0xd7, //o (alt. 0 0xd8)
+  0x8f, //P
+  0x1f, //q
+  0x88, //r
+  0x5b, //S (dupe of 5)
+  0xca, //t
+  0xd6, //U (alt. u 0xd0)
+  0xd0, //V (as u)
+  0x46, //W (approximation)
+  0x9e, //X (dupe of H)
+  0x5e, //y
+  0xcd, //Z (dupe of 2)
+  0xc3, //[
+  0x00, //backslash
+  0x55, //]
+  0x00, //^
+  0x40  //_
 };
 
 static const uint8_t kCharDecimal = 0x20;
+static const uint8_t kCharMinus = 0x08;
 
-//Global Char values for timer interrupt ISRs
-static uint8_t gDisplayCharBuffer[DISPLAY_CHAR_COUNT];
+//Busy spinner, a single segment chasing around the outline of the display
+//Pairs of frame position (0 = rightmost char) and segment bit
+#define DISPLAY_SPINNER_STEPS 10
+static const uint8_t kDisplaySpinner[DISPLAY_SPINNER_STEPS][2] PROGMEM = {
+  {2, 0x01}, {1, 0x01}, {0, 0x01}, {0, 0x04}, {0, 0x10},
+  {0, 0x40}, {1, 0x40}, {2, 0x40}, {2, 0x80}, {2, 0x02}
+};
+
+//Animation timing (ms)
+static const uint16_t kDisplayScrollInterval = 300;
+static const uint16_t kDisplayScrollHold = 1000;
+static const uint16_t kDisplaySpinnerInterval = 80;
+static const uint16_t kDisplayBlinkOnTime = 500;
+static const uint16_t kDisplayBlinkOffTime = 250;
+
+enum DisplayAnimation {
+  kDisplayAnimationNone,
+  kDisplayAnimationScroll,
+  kDisplayAnimationSpinner
+};
+
+//Global Char values for timer interrupt ISRs (DISPLAY_CHAR_OUTPUT_REG frames)
+//The ISR scans the front buffer, writers compose a full frame in the back buffer
+//and the ISR swaps them at the end of a scan so frames are never shown half written
+static uint8_t gDisplayCharBuffer[2][DISPLAY_CHAR_COUNT];
+static uint8_t * volatile gDisplayFront = gDisplayCharBuffer[0];
+static uint8_t * volatile gDisplayBack = gDisplayCharBuffer[1];
+static volatile uint8_t gDisplaySwapPending = 0;
 
+//Current message as chars (index 0 is leftmost), frames are rendered from it
+static uint8_t gDisplayText[DISPLAY_TEXT_LENGTH];
+static uint8_t gDisplayTextLength = 0;
+
+//Animation state, gDisplayStep is the scroll position or spinner step
+static enum DisplayAnimation gDisplayAnimation = kDisplayAnimationNone;
+static uint8_t gDisplayStep = 0;
+static uint16_t gDisplayStepTime = 0;
+static uint8_t gDisplayBlinkMask = 0;
+static uint8_t gDisplayBlinkHidden = 0;
+static uint16_t gDisplayBlinkTime = 0;
+
+//Last number written, rewriting an unchanged value is skipped
+static int gDisplayCachedNumber;
+static uint8_t gDisplayCachedPrecision;
+static uint8_t gDisplayCacheValid = 0;
+
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_MULTIPLEX
 //Global Char Scan Cursor Position for ISR: 0-2
 static volatile uint8_t gDisplayCharCursor = 0;
+#else
+//SPI frame transfer state, gDisplaySpiStep counts bytes sent of the front buffer
+static volatile uint8_t gDisplaySpiBusy = 0;
+static volatile uint8_t gDisplaySpiResend = 0;
+static volatile uint8_t gDisplaySpiStep = 0;
+#endif
+
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_HC595
+//One byte per digit, the first byte shifted out ends up in the last (leftmost) register
+#define DISPLAY_SPI_FRAME_LENGTH DISPLAY_CHAR_COUNT
+#elif DISPLAY_BACKEND == DISPLAY_BACKEND_MAX7219
+//Register address and data words: intensity followed by each digit
+#define DISPLAY_SPI_FRAME_LENGTH ((DISPLAY_CHAR_COUNT + 1) * 2)
 
-//Global millis counter
-static volatile uint32_t gDisplayMillis = 0;
+enum Max7219Register {
+  kMax7219Digit0 = 0x01,
+  kMax7219DecodeMode = 0x09,
+  kMax7219Intensity = 0x0a,
+  kMax7219ScanLimit = 0x0b,
+  kMax7219Shutdown = 0x0c,
+  kMax7219DisplayTest = 0x0f
+};
+
+static const uint8_t kMax7219IntensityMax = 15;
+static volatile uint8_t gDisplayIntensity = 0;
+#endif
+
+//Global tick counter incremented by the ISR, the ISR carries into the high word
+static volatile uint16_t gDisplayTicks = 0;
+static volatile uint16_t gDisplayTicksHigh = 0;
+
+//Brightness state
+static uint8_t gDisplayBrightness = DISPLAY_BRIGHTNESS_MAX;
+static uint8_t gDisplayDimLevel = 0;
+static uint16_t gDisplayDimTimeout = 0;
+static volatile uint8_t gDisplayDimmed = 0;
+static volatile uint32_t gDisplayActivityTime = 0;
+
+void display_apply_brightness(uint8_t level);
+void display_update_brightness(void);
+void display_update_animation(void);
+uint8_t *display_begin_frame(void);
+void display_end_frame(void);
+void display_render(void);
+void display_write_text(const char *text, uint8_t progmem);
+void display_show_text(const uint8_t *text, uint8_t length);
+uint8_t display_char(char c);
+uint8_t display_format_digits(uint16_t value, uint8_t minimumDigits, uint8_t *text);
+uint8_t display_format_number(int number, uint8_t precision, uint8_t *text);
+#if DISPLAY_BACKEND != DISPLAY_BACKEND_MULTIPLEX
+void display_spi_start(void);
+void display_spi_begin_transfer(void);
+uint8_t display_spi_byte(uint8_t step);
+#endif
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_MAX7219
+void display_max7219_write(uint8_t address, uint8_t data);
+uint8_t display_max7219_segments(uint8_t bmp);
+#endif
 
 void display_init(void)
 {
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_MULTIPLEX
+  //Select pins are active low, start with all digits off
+  DISPLAY_CHAR_SELECT_OUTPUT_REG |= kDisplayCharSelectPinMask;
+
   DISPLAY_CHAR_SELECT_DIR_REG |= kDisplayCharSelectPinMask;       //Enable Digit Select Pins as outputs
   DISPLAY_CHAR_DIR_REG |= kDisplayCharPinMask;                    //Enable Char pins as outputs
+#else
+  DISPLAY_CONTROL_OUTPUT_REG |= kDisplayEnablePin;                //Outputs disabled (74HC595 OE high)
+  DISPLAY_CONTROL_OUTPUT_REG &= ~kDisplayLatchPin;                //Latch low while shifting
+  DISPLAY_CONTROL_DIR_REG |= kDisplayControlPinMask;              //Enable control pins as outputs
+  DISPLAY_SPI_DIR_REG |= kDisplaySpiPinMask;                      //Enable SPI pins as outputs
+  DISPLAY_SPI_STATUS_REG |= kDisplaySpiDoubleSpeed;
+  DISPLAY_SPI_CONTROL_REG = kDisplaySpiControl;                   //Enable SPI master, polled for setup
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_MAX7219
+  display_max7219_write(kMax7219DisplayTest, 0);
+  display_max7219_write(kMax7219DecodeMode, 0);
+  display_max7219_write(kMax7219ScanLimit, DISPLAY_CHAR_COUNT - 1);
+  display_max7219_write(kMax7219Shutdown, 1);
+#endif
+  DISPLAY_SPI_CONTROL_REG = kDisplaySpiControl | kDisplaySpiInterrupt; //Frames are pushed by the transfer complete ISR
+#endif
   DISPLAY_TIMER_CONFIG_A_REG |= kDisplayTimerMode;                //Configure timer for CTC mode 
-  DISPLAY_TIMER_INTERRUPT_MASK_REG |= kDisplayTimerInterruptMask; //Enable timer interrupt
-  sei();                                                          //Enable global interrupts 
   DISPLAY_TIMER_COMPARE_VALUE_REG = kDisplayTimerCompareValue;    //Set compare value for a compare rate of 1kHz 
+  display_apply_brightness(gDisplayBrightness);                   //Set blanking compare value, auto-dim off until configured
+  DISPLAY_TIMER_INTERRUPT_MASK_REG |= kDisplayTimerInterruptMask; //Enable timer interrupts
+  sei();                                                          //Enable global interrupts 
   DISPLAY_TIMER_CONFIG_B_REG |= kDisplayTimerPrescaler;           //Set timer prescaler
 }
 
+void display_set_brightness(uint8_t level)
+{
+  gDisplayBrightness = level;
+  if (!gDisplayDimmed)
+    display_apply_brightness(level);
+}
+
+void display_set_auto_dim(uint8_t level, uint16_t timeout)
+{
+  gDisplayDimLevel = level;
+  gDisplayDimTimeout = timeout;
+  display_wake();
+}
+
+void display_wake(void)
+{
+  gDisplayActivityTime = millis();
+  if (gDisplayDimmed) {
+    gDisplayDimmed = 0;
+    display_apply_brightness(gDisplayBrightness);
+  }
+}
+
+void display_update(void)
+{
+  display_update_animation();
+  display_update_brightness();
+}
+
+void display_update_brightness(void)
+{
+  if (!gDisplayDimTimeout || gDisplayDimmed)
+    return;
+  //Atomic so an input ISR calling display_wake() can not be lost
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (millis() - gDisplayActivityTime >= (uint32_t)gDisplayDimTimeout * 1000) {
+      gDisplayDimmed = 1;
+      display_apply_brightness(gDisplayDimLevel);
+    }
+  }
+}
+
+void display_apply_brightness(uint8_t level)
+{
+  if (level > DISPLAY_BRIGHTNESS_MAX)
+    level = DISPLAY_BRIGHTNESS_MAX;
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_MAX7219
+  //Intensity register is sent ahead of the digits with every frame
+  gDisplayIntensity = (uint16_t)kMax7219IntensityMax * level / DISPLAY_BRIGHTNESS_MAX;
+  display_spi_start();
+#else
+  //Digits are blanked by the compare B ISR, at full brightness one timer count before the next digit
+  uint8_t blankValue = (uint16_t)kDisplayTimerCompareValue * level / DISPLAY_BRIGHTNESS_MAX;
+  if (blankValue >= kDisplayTimerCompareValue)
+    blankValue = kDisplayTimerCompareValue - 1;
+  if (!blankValue)
+    blankValue = 1;
+  DISPLAY_TIMER_BLANK_VALUE_REG = blankValue;
+#endif
+}
+
 void display_write_number(int number, uint8_t precision)
 {
-  if (number > DISPLAY_MAX_NUMBER || number < 0)
+  if (gDisplayCacheValid && number == gDisplayCachedNumber && precision == gDisplayCachedPrecision)
+    return;
+
+  uint8_t text[DISPLAY_TEXT_LENGTH];
+  uint8_t length = display_format_number(number, precision, text);
+  if (length < DISPLAY_CHAR_COUNT) {
+    //Right align numbers that fit the display
+    uint8_t shift = DISPLAY_CHAR_COUNT - length;
+    memmove(text + shift, text, length);
+    memset(text, 0, shift);
+    length = DISPLAY_CHAR_COUNT;
+  }
+  display_show_text(text, length);
+
+  gDisplayCachedNumber = number;
+  gDisplayCachedPrecision = precision;
+  gDisplayCacheValid = 1;
+}
+
+void display_write_time(uint16_t seconds)
+{
+  uint16_t minutes = (uint32_t)seconds * 34953 >> 21; //seconds / 60 for all 16 bit values
+  if (minutes < 10) {
+    //m.ss fits the display
+    display_write_number(minutes * 100 + (seconds - minutes * 60), 2);
     return;
-  char displayNum[DISPLAY_CHAR_COUNT + 1];
-  itoa(number, displayNum, 10);
-  uint8_t displayLen = strlen(displayNum);
-  
-  for(uint8_t i = DISPLAY_CHAR_COUNT; i; --i) {
-    gDisplayCharBuffer[i - 1] = displayLen < i ? 0 : kCharTable[displayNum[displayLen - i] - '0'];
-    if (precision && (precision + 1 == i))
-      gDisplayCharBuffer[i - 1] |= kCharDecimal;
-    else
-      gDisplayCharBuffer[i - 1] &= ~kCharDecimal;
   }
+
+  //Scroll as mm.ss or h.mm.ss
+  uint8_t text[DISPLAY_TEXT_LENGTH];
+  uint8_t length = 0;
+  uint8_t hours = (uint32_t)minutes * 1093 >> 16;      //minutes / 60 for minutes < 1093
+  if (hours) {
+    length = display_format_digits(hours, 1, text);
+    text[length - 1] |= kCharDecimal;
+  }
+  length += display_format_digits(minutes - hours * 60, 2, text + length);
+  text[length - 1] |= kCharDecimal;
+  length += display_format_digits(seconds - minutes * 60, 2, text + length);
+  display_show_text(text, length);
+  gDisplayCacheValid = 0;
 }
 
 void display_write_string(const char *text)
 {
-  uint8_t cursor = DISPLAY_CHAR_COUNT;
-  while(*text && cursor) {
-    uint8_t bmp = 0x00;
-    if(*text >= '0' && *text <= '9')
-      bmp = kCharTable[*text - '0'];       //Handle Digits
-    else if (*text >= 'A' && *text <= 'Z')
-      bmp = kCharTable[*text - 55];        //Handle A-U
-    else if (*text >= 'a' && *text <= 'z')
-      bmp = kCharTable[*text - 87];        //Handle A-U
-    gDisplayCharBuffer[--cursor] = bmp;
+  display_write_text(text, 0);
+}
+
+void display_write_string_P(const char *text)
+{
+  display_write_text(text, 1);
+}
+
+void display_write_text(const char *text, uint8_t progmem)
+{
+  uint8_t chars[DISPLAY_TEXT_LENGTH];
+  uint8_t length = 0;
+  char c;
+  while ((c = progmem ? pgm_read_byte(text) : *text) && length < DISPLAY_TEXT_LENGTH) {
     ++text;
+    //Merge a decimal point into the previous char
+    if (c == '.' && length && !(chars[length - 1] & kCharDecimal)) {
+      chars[length - 1] |= kCharDecimal;
+      continue;
+    }
+    chars[length++] = display_char(c);
   }
+  display_show_text(chars, length);
+  gDisplayCacheValid = 0;
+}
+
+void display_write_spinner(void)
+{
+  if (gDisplayAnimation == kDisplayAnimationSpinner)
+    return;
+  gDisplayAnimation = kDisplayAnimationSpinner;
+  gDisplayTextLength = 0;
+  gDisplayStep = 0;
+  gDisplayStepTime = millis16();
+  gDisplayCacheValid = 0;
+  display_render();
+}
+
+void display_set_blink(uint8_t mask)
+{
+  if (mask == gDisplayBlinkMask)
+    return;
+  gDisplayBlinkMask = mask;
+  gDisplayBlinkHidden = 0;
+  gDisplayBlinkTime = millis16();
+  display_render();
+}
+
+void display_update_animation(void)
+{
+  uint16_t timestamp = millis16();
+  uint8_t renderRequired = 0;
+
+  if (gDisplayBlinkMask && (uint16_t)(timestamp - gDisplayBlinkTime) >= (gDisplayBlinkHidden ? kDisplayBlinkOffTime : kDisplayBlinkOnTime)) {
+    gDisplayBlinkHidden = !gDisplayBlinkHidden;
+    gDisplayBlinkTime = timestamp;
+    renderRequired = 1;
+  }
+
+  uint16_t elapsed = timestamp - gDisplayStepTime;
+  switch (gDisplayAnimation) {
+    case kDisplayAnimationScroll:
+      if (elapsed >= (gDisplayStep ? kDisplayScrollInterval : kDisplayScrollHold)) {
+        //Message is followed by a blank gap the width of the display before repeating
+        if (++gDisplayStep == gDisplayTextLength + DISPLAY_CHAR_COUNT)
+          gDisplayStep = 0;
+        gDisplayStepTime = timestamp;
+        renderRequired = 1;
+      }
+      break;
+    case kDisplayAnimationSpinner:
+      if (elapsed >= kDisplaySpinnerInterval) {
+        if (++gDisplayStep == DISPLAY_SPINNER_STEPS)
+          gDisplayStep = 0;
+        gDisplayStepTime = timestamp;
+        renderRequired = 1;
+      }
+      break;
+    default:
+      break;
+  }
+
+  if (renderRequired)
+    display_render();
+}
+
+void display_show_text(const uint8_t *text, uint8_t length)
+{
+  //Rewriting the current message keeps its scroll position
+  if (gDisplayAnimation != kDisplayAnimationSpinner && length == gDisplayTextLength && !memcmp(text, gDisplayText, length))
+    return;
+  memcpy(gDisplayText, text, length);
+  gDisplayTextLength = length;
+  gDisplayAnimation = length > DISPLAY_CHAR_COUNT ? kDisplayAnimationScroll : kDisplayAnimationNone;
+  gDisplayStep = 0;
+  gDisplayStepTime = millis16();
+  //Show new content immediately even when blinking
+  gDisplayBlinkHidden = 0;
+  gDisplayBlinkTime = gDisplayStepTime;
+  display_render();
+}
+
+void display_render(void)
+{
+  uint8_t *frame = display_begin_frame();
+  for (uint8_t i = DISPLAY_CHAR_COUNT; i; --i) {
+    //Frame position i - 1 shows message char gDisplayStep + DISPLAY_CHAR_COUNT - i
+    uint8_t bmp = 0x00;
+    if (gDisplayAnimation != kDisplayAnimationSpinner) {
+      uint8_t position = gDisplayStep + DISPLAY_CHAR_COUNT - i;
+      if (position >= gDisplayTextLength + DISPLAY_CHAR_COUNT)
+        position -= gDisplayTextLength + DISPLAY_CHAR_COUNT;
+      if (position < gDisplayTextLength)
+        bmp = gDisplayText[position];
+    }
+    if (gDisplayBlinkHidden && (gDisplayBlinkMask & _BV(i - 1)))
+      bmp = 0x00;
+    frame[i - 1] = bmp;
+  }
+  if (gDisplayAnimation == kDisplayAnimationSpinner)
+    frame[pgm_read_byte(&kDisplaySpinner[gDisplayStep][0])] = pgm_read_byte(&kDisplaySpinner[gDisplayStep][1]);
+  display_end_frame();
+}
+
+uint8_t *display_begin_frame(void)
+{
+  //Cancelling a pending swap hands the back buffer to the writer until display_end_frame()
+  gDisplaySwapPending = 0;
+  return gDisplayBack;
+}
+
+void display_end_frame(void)
+{
+  gDisplaySwapPending = 1;
+#if DISPLAY_BACKEND != DISPLAY_BACKEND_MULTIPLEX
+  display_spi_start();
+#endif
+}
+
+#if DISPLAY_BACKEND != DISPLAY_BACKEND_MULTIPLEX
+void display_spi_start(void)
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    //A transfer in progress restarts from its ISR once complete
+    if (gDisplaySpiBusy)
+      gDisplaySpiResend = 1;
+    else
+      display_spi_begin_transfer();
+  }
+}
+
+void display_spi_begin_transfer(void)
+{
+  //Called with interrupts disabled
+  if (gDisplaySwapPending) {
+    uint8_t *front = gDisplayFront;
+    gDisplayFront = gDisplayBack;
+    gDisplayBack = front;
+    gDisplaySwapPending = 0;
+  }
+  gDisplaySpiResend = 0;
+  gDisplaySpiBusy = 1;
+  gDisplaySpiStep = 0;
+  DISPLAY_SPI_DATA_REG = display_spi_byte(0);
+}
+
+uint8_t display_spi_byte(uint8_t step)
+{
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_HC595
+  return gDisplayFront[DISPLAY_CHAR_COUNT - 1 - step];
+#else
+  uint8_t word = step >> 1;
+  if (!(step & 1))
+    return word ? kMax7219Digit0 + word - 1 : kMax7219Intensity;
+  return word ? display_max7219_segments(gDisplayFront[word - 1]) : gDisplayIntensity;
+#endif
+}
+#endif
+
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_MAX7219
+void display_max7219_write(uint8_t address, uint8_t data)
+{
+  //Polled write, only used before the SPI interrupt is enabled
+  DISPLAY_SPI_DATA_REG = address;
+  while (!(DISPLAY_SPI_STATUS_REG & _BV(SPIF)));
+  DISPLAY_SPI_DATA_REG = data;
+  while (!(DISPLAY_SPI_STATUS_REG & _BV(SPIF)));
+  DISPLAY_CONTROL_OUTPUT_REG |= kDisplayLatchPin;
+  DISPLAY_CONTROL_OUTPUT_REG &= ~kDisplayLatchPin;
+}
+
+uint8_t display_max7219_segments(uint8_t bmp)
+{
+  //Port bit map ED.C GBFA to MAX7219 no decode bit map .ABC DEFG
+  uint8_t segments = 0;
+  if (bmp & 0x01) segments |= 0x40; //A
+  if (bmp & 0x04) segments |= 0x20; //B
+  if (bmp & 0x10) segments |= 0x10; //C
+  if (bmp & 0x40) segments |= 0x08; //D
+  if (bmp & 0x80) segments |= 0x04; //E
+  if (bmp & 0x02) segments |= 0x02; //F
+  if (bmp & 0x08) segments |= 0x01; //G
+  if (bmp & 0x20) segments |= 0x80; //Decimal point
+  return segments;
+}
+#endif
+
+uint8_t display_char(char c)
+{
+  if (c >= 'a' && c <= 'z')
+    c -= 'a' - 'A';
+  if (c < ' ' || c > '_')
+    return 0x00;
+  return pgm_read_byte(&kCharTable[c - ' ']);
+}
+
+uint8_t display_format_digits(uint16_t value, uint8_t minimumDigits, uint8_t *text)
+{
+  //Division free decimal conversion, digits[0] is the most significant of 5
+  uint8_t digits[5] = {0, 0, 0, 0, 0};
+  while (value >= 10000) {
+    value -= 10000;
+    ++digits[0];
+  }
+  while (value >= 1000) {
+    value -= 1000;
+    ++digits[1];
+  }
+  //0-999 by multiply and shift, exact over this range
+  digits[2] = (value * 41) >> 12;
+  uint8_t remainder = value - digits[2] * 100;
+  digits[3] = (remainder * 205) >> 11;
+  digits[4] = remainder - digits[3] * 10;
+
+  //Skip leading zeros beyond minimumDigits (always at least one digit)
+  uint8_t first = 0;
+  while (first < 4 && !digits[first] && 5 - first > minimumDigits)
+    ++first;
+  uint8_t length = 0;
+  for (uint8_t i = first; i < 5; ++i)
+    text[length++] = pgm_read_byte(&kCharTable['0' - ' ' + digits[i]]);
+  return length;
+}
+
+uint8_t display_format_number(int number, uint8_t precision, uint8_t *text)
+{
+  uint8_t length = 0;
+  uint16_t magnitude = number;
+  if (number < 0) {
+    text[length++] = kCharMinus;
+    magnitude = 0 - magnitude;
+  }
+  //Always show the digit ahead of the decimal point (ie 0.5)
+  length += display_format_digits(magnitude, precision + 1, text + length);
+  if (precision)
+    text[length - 1 - precision] |= kCharDecimal;
+  return length;
 }
 
 uint32_t millis(void)
@@ -106,22 +590,93 @@ uint32_t millis(void)
   unsigned long ms;
   ATOMIC_BLOCK(ATOMIC_RESTORESTATE) 
   { 
-    ms = gDisplayMillis;
+    ms = ((uint32_t)gDisplayTicksHigh << 16) | gDisplayTicks;
   } 
   return ms;
 }
 
+uint16_t millis16(void)
+{
+  uint16_t ticks;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) 
+  { 
+    ticks = gDisplayTicks;
+  } 
+  return ticks;
+}
+
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_MULTIPLEX
 ISR(TIMER0_COMPA_vect) 
 {
-  //Increment global millis counter
-  ++gDisplayMillis;
+  //Increment global tick counter
+  if (!++gDisplayTicks)
+    ++gDisplayTicksHigh;
 
-  //Bring all digit select pins high
+  //Digits were blanked by compare B, write char value then select current digit
+  uint8_t cursor = gDisplayCharCursor;
+  DISPLAY_CHAR_OUTPUT_REG = gDisplayFront[cursor];
+  //Only the select pins are written, the port's other bits stay as the rest of the firmware left them
+  DISPLAY_CHAR_SELECT_OUTPUT_REG = (DISPLAY_CHAR_SELECT_OUTPUT_REG | kDisplayCharSelectPinMask) & ~kDisplayCharSelect[cursor];
+  if (++cursor == DISPLAY_CHAR_COUNT) {
+    cursor = 0;
+    //Frame boundary, show a newly written frame
+    if (gDisplaySwapPending) {
+      uint8_t *front = gDisplayFront;
+      gDisplayFront = gDisplayBack;
+      gDisplayBack = front;
+      gDisplaySwapPending = 0;
+    }
+  }
+  gDisplayCharCursor = cursor;
+}
+
+ISR(TIMER0_COMPB_vect) 
+{
+  //End of the digit on time, bring all digit select pins high
   DISPLAY_CHAR_SELECT_OUTPUT_REG |= kDisplayCharSelectPinMask;
-  //Write char value
-  DISPLAY_CHAR_OUTPUT_REG = gDisplayCharBuffer[gDisplayCharCursor];
-  //Bring current digit select pin low
-  DISPLAY_CHAR_SELECT_OUTPUT_REG &= ~(kDisplayCharSelect[gDisplayCharCursor++]);
-  if (gDisplayCharCursor == DISPLAY_CHAR_COUNT)
-    gDisplayCharCursor = 0;
-}
\ No newline at end of file
+}
+#else
+ISR(TIMER0_COMPA_vect) 
+{
+  //Increment global tick counter
+  if (!++gDisplayTicks)
+    ++gDisplayTicksHigh;
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_HC595
+  //Start of the on time, enable 74HC595 outputs
+  DISPLAY_CONTROL_OUTPUT_REG &= ~kDisplayEnablePin;
+#endif
+}
+
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_HC595
+ISR(TIMER0_COMPB_vect) 
+{
+  //End of the on time, disable 74HC595 outputs
+  DISPLAY_CONTROL_OUTPUT_REG |= kDisplayEnablePin;
+}
+#endif
+
+ISR(SPI_STC_vect) 
+{
+  uint8_t step = ++gDisplaySpiStep;
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_MAX7219
+  //Latch each address and data word
+  if (!(step & 1)) {
+    DISPLAY_CONTROL_OUTPUT_REG |= kDisplayLatchPin;
+    DISPLAY_CONTROL_OUTPUT_REG &= ~kDisplayLatchPin;
+  }
+#endif
+  if (step < DISPLAY_SPI_FRAME_LENGTH) {
+    DISPLAY_SPI_DATA_REG = display_spi_byte(step);
+    return;
+  }
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_HC595
+  //Whole chain shifted, latch all digits at once
+  DISPLAY_CONTROL_OUTPUT_REG |= kDisplayLatchPin;
+  DISPLAY_CONTROL_OUTPUT_REG &= ~kDisplayLatchPin;
+#endif
+  gDisplaySpiBusy = 0;
+  //Push a frame written or a brightness change made during the transfer
+  if (gDisplaySwapPending || gDisplaySpiResend)
+    display_spi_begin_transfer();
+}
+#endif
\ No newline at end of file
@@ -4,16 +4,57 @@
 #include <stdint.h>
 #include <avr/io.h> 
 
+#define DISPLAY_BRIGHTNESS_MAX 8
+
+//Longest message, longer strings are truncated
+#define DISPLAY_TEXT_LENGTH 16
+
+//Blink mask covering every char
+#define DISPLAY_BLINK_ALL 0xff
+
 //Function declarations
 void display_init(void);
 
+//Set digit duty cycle, 1 (dimmest) to DISPLAY_BRIGHTNESS_MAX
+void display_set_brightness(uint8_t level);
+
+//Dim to level after timeout seconds without display_wake() (0 = never)
+void display_set_auto_dim(uint8_t level, uint16_t timeout);
+
+//Register user activity, restores full brightness
+void display_wake(void);
+
+//Process animations and auto-dim, call from the main loop
+void display_update(void);
+
+//Messages longer than the display scroll continuously (driven by display_update)
+//Rewriting the message already shown is a no-op and keeps its scroll position
+
 //Write a number with static decimal point
 //precision: 0 = No decimal point (ie 1), 1 = Char 2 (ie 1.0), 2 = Char 3 (ie 1.00)
+//Negative numbers are shown with a leading minus (ie -5.2)
 void display_write_number(int number, uint8_t precision);
 
-//Write a string (limited to display size, limited char support 0-9, A-U)
+//Write a duration as m.ss below 10 minutes, scrolling mm.ss or h.mm.ss above
+void display_write_time(uint16_t seconds);
+
+//Write a string (0-9, A-Z with 7 segment approximations, some punctuation)
+//A '.' is merged into the preceding char
 void display_write_string(const char* text);
 
+//Write a string held in flash (PSTR() or PROGMEM)
+void display_write_string_P(const char* text);
+
+//Show a busy animation until the next write
+void display_write_spinner(void);
+
+//Blink chars in mask (bit 0 = rightmost char), 0 = no blink
+void display_set_blink(uint8_t mask);
+
+//Milliseconds since display_init()
 uint32_t millis(void);
 
+//Low 16 bits of millis(), cheaper for timestamps and short intervals
+uint16_t millis16(void);
+
 #endif
@@ -5,6 +5,7 @@
 
 #include "display.h" //Provides millis()
 #include "hwprofile.h"
+#include "trace.h"
 
 static const uint16_t kEncoderOKDuration = 50;
 static const uint16_t kEncoderCancelDuration = 1000;
@@ -109,6 +110,9 @@ ISR(ENCODER_PCINT_VECTOR)
   uint8_t encoderBits = ENCODER_INPUT_REG;
   uint8_t encoderChangedBits = gEncoderLastBits ^ encoderBits;
 
+  //Any input restores full display brightness
+  display_wake();
+
   //Process Encoder A Pin Rising
   if ((encoderChangedBits & kEncoderPinA) && (encoderBits & kEncoderPinA)) {
     if(encoderBits & kEncoderPinB) {
@@ -121,10 +125,12 @@ ISR(ENCODER_PCINT_VECTOR)
         ++gEncoderValue;
     }
     gEncoderChanged = 1; //Flag value as changed
+    trace_record(kTraceEncoderStep, encoderBits & kEncoderPinMask);
   }
 
   //Process Enter Pin Change
   if (encoderChangedBits & kEncoderPinE) {
+    trace_record(kTraceButton, encoderBits & kEncoderPinMask);
     switch (gEncoderEnterState) {
       case kEncoderEnterStateIdle:
         //Button is pushed (ActiveLow)
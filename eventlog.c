@@ -0,0 +1,174 @@
+#include "eventlog.h"
+
+#include <stddef.h>
+#include <avr/eeprom.h>
+#include <avr/io.h>
+#include <util/crc16.h>
+
+#include "display.h" //Provides millis()
+#include "settings.h"
+#include "uart.h"
+
+//Records fill the EEPROM after the settings and the watchdog fault counter (EEMEM variables from address 0)
+#define EVENTLOG_RECORD_COUNT ((E2END + 1 - sizeof(struct BoilPowerSettings) - sizeof(uint16_t)) / sizeof(struct EventLogRecord))
+
+//Placed at the end of the EEPROM, clear of the EEMEM variables whatever their link order
+#define EVENTLOG_EEPROM_START (E2END + 1 - EVENTLOG_RECORD_COUNT * sizeof(struct EventLogRecord))
+
+//Sequence numbers are 8 bit, the newest record is only unique with fewer slots
+_Static_assert(EVENTLOG_RECORD_COUNT > 1 && EVENTLOG_RECORD_COUNT < 256, "Event log size out of range");
+
+//Pending records waiting for the EEPROM (must be a power of 2)
+//Boot alone queues up to boot, fault, settings and lock before the first write finishes
+#define EVENTLOG_QUEUE_SIZE 8
+
+#define EVENTLOG_EEPROM ((struct EventLogRecord *)EVENTLOG_EEPROM_START)
+
+//Records queued for writing, the head record is written one byte per eventlog_update()
+static struct EventLogRecord gEventLogQueue[EVENTLOG_QUEUE_SIZE];
+static uint8_t gEventLogQueueHead = 0;
+static uint8_t gEventLogQueueCount = 0;
+static uint8_t gEventLogWriteByte = 0;
+
+//Slot of the newest stored record, number of stored records and next sequence number
+static uint8_t gEventLogNewest = EVENTLOG_RECORD_COUNT - 1;
+static uint8_t gEventLogCount = 0;
+static uint8_t gEventLogSequence = 0;
+
+//Keeps erased (0xff) and zeroed records from passing the crc check
+static const uint8_t kEventLogCrcSeed = 0xa5;
+
+uint8_t eventlog_read(uint8_t slot, struct EventLogRecord *record);
+uint8_t eventlog_crc(const struct EventLogRecord *record);
+uint8_t eventlog_previous_slot(uint8_t slot);
+
+void eventlog_init(void)
+{
+  //The newest record is the valid one not followed by its successor
+  struct EventLogRecord current, next;
+  uint8_t currentValid = eventlog_read(0, &current);
+  uint8_t slot = 0;
+  for (; slot < EVENTLOG_RECORD_COUNT; ++slot) {
+    uint8_t nextValid = eventlog_read(slot + 1 < EVENTLOG_RECORD_COUNT ? slot + 1 : 0, &next);
+    if (currentValid && !(nextValid && next.sequence == (uint8_t)(current.sequence + 1)))
+      break;
+    current = next;
+    currentValid = nextValid;
+  }
+  if (slot == EVENTLOG_RECORD_COUNT)
+    return; //Empty log
+
+  gEventLogNewest = slot;
+  gEventLogSequence = current.sequence + 1;
+
+  //Count the unbroken run of records back from the newest
+  uint8_t sequence = current.sequence;
+  while (gEventLogCount < EVENTLOG_RECORD_COUNT && eventlog_read(slot, &current) && current.sequence == sequence) {
+    ++gEventLogCount;
+    --sequence;
+    slot = eventlog_previous_slot(slot);
+  }
+}
+
+void eventlog_record(uint8_t type, uint8_t data)
+{
+  if (gEventLogQueueCount == EVENTLOG_QUEUE_SIZE)
+    return;
+  struct EventLogRecord *record = &gEventLogQueue[(gEventLogQueueHead + gEventLogQueueCount) & (EVENTLOG_QUEUE_SIZE - 1)];
+  record->sequence = gEventLogSequence++;
+  record->type = type;
+  record->data = data;
+  record->time = millis() >> 10;
+  record->crc = eventlog_crc(record);
+  ++gEventLogQueueCount;
+}
+
+void eventlog_update(void)
+{
+  if (!gEventLogQueueCount || !eeprom_is_ready())
+    return;
+
+  uint8_t slot = gEventLogNewest + 1 < EVENTLOG_RECORD_COUNT ? gEventLogNewest + 1 : 0;
+  //A full log loses its oldest record as soon as the slot is touched
+  if (!gEventLogWriteByte && gEventLogCount == EVENTLOG_RECORD_COUNT)
+    --gEventLogCount;
+
+  //Unchanged bytes are not rewritten, the crc goes last so a torn record stays invalid
+  const uint8_t *source = (const uint8_t *)&gEventLogQueue[gEventLogQueueHead];
+  eeprom_update_byte((uint8_t *)&EVENTLOG_EEPROM[slot] + gEventLogWriteByte, source[gEventLogWriteByte]);
+  if (++gEventLogWriteByte < sizeof(struct EventLogRecord))
+    return;
+
+  gEventLogWriteByte = 0;
+  gEventLogNewest = slot;
+  ++gEventLogCount;
+  gEventLogQueueHead = (gEventLogQueueHead + 1) & (EVENTLOG_QUEUE_SIZE - 1);
+  --gEventLogQueueCount;
+}
+
+uint8_t eventlog_count(void)
+{
+  return gEventLogCount;
+}
+
+uint8_t eventlog_get(uint8_t index, struct EventLogRecord *record)
+{
+  if (index >= gEventLogCount)
+    return 0;
+  uint8_t slot = gEventLogNewest >= index ? gEventLogNewest - index : gEventLogNewest + EVENTLOG_RECORD_COUNT - index;
+  return eventlog_read(slot, record);
+}
+
+void eventlog_dump(void (*service)(void))
+{
+  //Output format, one record per line oldest first (hex): "ss ee dd tttt"
+  //tttt is seconds since that boot in 1.024s units, 16 bit so it wraps after ~18.6h of uptime
+  //Header line: "#log <count>"
+  uint8_t count = gEventLogCount;
+  uint8_t slot = gEventLogNewest;
+  for (uint8_t i = 1; i < count; ++i)
+    slot = eventlog_previous_slot(slot);
+
+  uart_init();
+  uart_write_string("#log ");
+  uart_write_hex(count);
+  uart_write_string("\r\n");
+  for (; count; --count) {
+    struct EventLogRecord record;
+    if (eventlog_read(slot, &record)) {
+      uart_write_hex(record.sequence);
+      uart_write(' ');
+      uart_write_hex(record.type);
+      uart_write(' ');
+      uart_write_hex(record.data);
+      uart_write(' ');
+      uart_write_hex(record.time >> 8);
+      uart_write_hex(record.time);
+      uart_write_string("\r\n");
+    }
+    slot = slot + 1 < EVENTLOG_RECORD_COUNT ? slot + 1 : 0;
+    if (service)
+      service();
+  }
+  uart_disable();
+}
+
+uint8_t eventlog_read(uint8_t slot, struct EventLogRecord *record)
+{
+  eeprom_read_block((void*)record, (const void*)&EVENTLOG_EEPROM[slot], sizeof(*record));
+  return record->crc == eventlog_crc(record);
+}
+
+uint8_t eventlog_crc(const struct EventLogRecord *record)
+{
+  uint8_t crc = kEventLogCrcSeed;
+  const uint8_t *chunk = (const uint8_t *)record;
+  for (uint8_t i = 0; i < offsetof(struct EventLogRecord, crc); i++)
+    crc = _crc_ibutton_update(crc, *chunk++);
+  return crc;
+}
+
+uint8_t eventlog_previous_slot(uint8_t slot)
+{
+  return slot ? slot - 1 : EVENTLOG_RECORD_COUNT - 1;
+}
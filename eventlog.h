@@ -0,0 +1,45 @@
+#ifndef BOILPOWER_EVENTLOG_H_
+#define BOILPOWER_EVENTLOG_H_
+
+#include <stdint.h>
+
+//Events kept across resets in the EEPROM left after the settings
+enum EventLogType {
+  kEventLogBoot,        //data: MCUSR reset flags
+  kEventLogFault,       //data: WatchdogFault code
+  kEventLogMainsLost,   //data: measured frequency before the zero-cross signal was lost (logged once lost for 10s)
+  kEventLogMainsLocked, //data: measured frequency in Hz (logged once locked for 10s)
+  kEventLogSettings,    //data: settings crc written
+  kEventLogLock,        //data: 1 = locked, 0 = unlocked
+  kEventLogProbeLost,   //data: 0
+  kEventLogBoil,        //data: detected boil point in degrees C
+  kEventLogNumTypes
+};
+
+struct EventLogRecord {
+  uint8_t sequence;     //Increments per record, locates the newest record
+  uint8_t type;
+  uint8_t data;
+  uint16_t time;        //Seconds since boot (1.024s units), wraps after ~18.6h of uptime
+  uint8_t crc;          //Over the bytes above, written last
+};
+
+//Locate the newest record, call once at start-up
+void eventlog_init(void);
+
+//Queue an event for writing (main loop only, dropped if the queue is full)
+void eventlog_record(uint8_t type, uint8_t data);
+
+//Write queued events one byte at a time while the EEPROM is idle, call from the main loop
+void eventlog_update(void);
+
+//Number of valid records stored
+uint8_t eventlog_count(void);
+
+//Read record at index (0 = newest), returns 0 if the record is invalid
+uint8_t eventlog_get(uint8_t index, struct EventLogRecord *record);
+
+//Write all stored records as text over the UART, service is called between records
+void eventlog_dump(void (*service)(void));
+
+#endif
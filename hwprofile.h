@@ -1,6 +1,32 @@
 #ifndef BOILPOWER_HWPROFILE_H_
 #define BOILPOWER_HWPROFILE_H_
 
+/* Board profile, MCU and F_CPU come from BOARD in the Makefile */
+//ATmega168/328P and ATtiny88 share the 28 pin layout, the pin map below applies to all of them
+#if defined(__AVR_ATmega168__) || defined(__AVR_ATmega168P__) || defined(__AVR_ATmega328P__)
+#define HWPROFILE_UART 1  //USART0 carries the trace dump
+#define HWPROFILE_TRACE_SIZE 32
+#elif defined(__AVR_ATtiny88__)
+#define HWPROFILE_UART 0  //No USART, trace dump disabled
+#define HWPROFILE_TRACE_SIZE 8  //Only 512 bytes of SRAM, and no dump to keep events for
+#else
+#error "Unsupported MCU, select a BOARD in the Makefile"
+#endif
+
+//Display backends
+#define DISPLAY_BACKEND_MULTIPLEX 0 //Segments on PORTD, digits multiplexed from PORTC by the display timer
+#define DISPLAY_BACKEND_HC595     1 //One 74HC595 per digit chained on hardware SPI
+#define DISPLAY_BACKEND_MAX7219   2 //MAX7219 (no decode mode) on hardware SPI
+
+//Selected display backend (may be overridden with -DDISPLAY_BACKEND=..., SPI backends also need -DSTATUS_LEDS=0)
+#ifndef DISPLAY_BACKEND
+#define DISPLAY_BACKEND DISPLAY_BACKEND_MULTIPLEX
+#endif
+
+#define DISPLAY_CHAR_COUNT 3
+
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_MULTIPLEX
+
 //Display output registers
 #define DISPLAY_CHAR_SELECT_OUTPUT_REG PORTC
 #define DISPLAY_CHAR_OUTPUT_REG        PORTD
@@ -14,20 +40,68 @@ static const uint8_t kDisplayCharSelectPinMask  = 0x38;
 static const uint8_t kDisplayCharPinMask         = 0xff;
 
 //Display char select bit map
-#define DISPLAY_CHAR_COUNT 3
-#define DISPLAY_MAX_NUMBER 999
 static const uint8_t kDisplayCharSelect[DISPLAY_CHAR_COUNT] = {_BV(5), _BV(4), _BV(3)};
 
-//Display Timer Configuration
+#else
+
+/* Display SPI MOSI PB3, SCK PB5, SS PB2 (PWM output, stays an output so SPI remains master) */
+//Display SPI registers
+#define DISPLAY_SPI_DIR_REG     DDRB
+#define DISPLAY_SPI_CONTROL_REG SPCR
+#define DISPLAY_SPI_STATUS_REG  SPSR
+#define DISPLAY_SPI_DATA_REG    SPDR
+
+static const uint8_t kDisplaySpiPinMask = 0x2c;
+static const uint8_t kDisplaySpiControl = (_BV(SPE) | _BV(MSTR)); //Mode 0, MSB first
+static const uint8_t kDisplaySpiInterrupt = _BV(SPIE);
+static const uint8_t kDisplaySpiDoubleSpeed = _BV(SPI2X);         //F_CPU / 2
+
+/* Display latch PC3 (74HC595 RCLK, MAX7219 LOAD), output enable PC4 (74HC595 OE, active low) */
+//Display control registers
+#define DISPLAY_CONTROL_OUTPUT_REG PORTC
+#define DISPLAY_CONTROL_DIR_REG    DDRC
+
+static const uint8_t kDisplayControlPinMask = 0x18;
+static const uint8_t kDisplayLatchPin = _BV(3);
+static const uint8_t kDisplayEnablePin = _BV(4);
+
+#endif
+
+//Display Timer Configuration (CTC at 1kHz, also the millis() time base)
+#if defined(__AVR_ATtiny88__)
+#define DISPLAY_TIMER_CONFIG_A_REG        TCCR0A
+#define DISPLAY_TIMER_CONFIG_B_REG        TCCR0A //Mode and clock select share TCCR0A
+#else
 #define DISPLAY_TIMER_CONFIG_A_REG        TCCR0A
 #define DISPLAY_TIMER_CONFIG_B_REG        TCCR0B
+#endif
 #define DISPLAY_TIMER_INTERRUPT_MASK_REG  TIMSK0
 #define DISPLAY_TIMER_COMPARE_VALUE_REG   OCR0A
+#define DISPLAY_TIMER_BLANK_VALUE_REG     OCR0B
 
+#if defined(__AVR_ATtiny88__)
+static const uint8_t kDisplayTimerMode = _BV(CTC0);
+#else
 static const uint8_t kDisplayTimerMode = _BV(WGM01);
-static const uint8_t kDisplayTimerInterruptMask = _BV(OCIE0A);
-static const uint8_t kDisplayTimerCompareValue = 125;
+#endif
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_MAX7219
+static const uint8_t kDisplayTimerInterruptMask = _BV(OCIE0A);                //Millis only, MAX7219 multiplexes itself
+#else
+static const uint8_t kDisplayTimerInterruptMask = (_BV(OCIE0A) | _BV(OCIE0B)); //Compare B blanks for brightness control
+#endif
+
+//Smallest prescaler keeping the compare value within 8 bits
+#if F_CPU / 64 / 1000 <= 256
+#define DISPLAY_TIMER_PRESCALER 64
 static const uint8_t kDisplayTimerPrescaler = (_BV(CS00) | _BV(CS01));
+#else
+#define DISPLAY_TIMER_PRESCALER 256
+static const uint8_t kDisplayTimerPrescaler = _BV(CS02);
+#endif
+#if F_CPU / DISPLAY_TIMER_PRESCALER % 1000
+#warning "F_CPU is not a multiple of the display timer rate, millis() will drift"
+#endif
+static const uint8_t kDisplayTimerCompareValue = F_CPU / DISPLAY_TIMER_PRESCALER / 1000 - 1; //CTC counts compare value + 1
 
 
 
@@ -54,14 +128,30 @@ static const uint8_t kEncoderPCINTMask = _BV(PCINT8) | _BV(PCINT10);
 
 
 
+/* Status Heat PB4 (PB0 is the mains zero-cross input), Lock PB1, Debug/Boil PB5 */
+//No pin is free for Heat in every display backend (multiplex uses all of PORTD and PC3-PC5, 16MHz boards PB6/PB7)
 //Status output register
 #define STATUS_OUTPUT_REG PORTB
 
 //Status direction register
 #define STATUS_DIR_REG DDRB
 
+//Heat and Debug/Boil LEDs on PB4/PB5 (may be overridden with -DSTATUS_LEDS=0 to keep the Lock LED only)
+#ifndef STATUS_LEDS
+#define STATUS_LEDS 1
+#endif
+
+//SPI display backends take PB5 as SCK and PB4 as MISO, forced to an input while SPI is master
+#if STATUS_LEDS && DISPLAY_BACKEND != DISPLAY_BACKEND_MULTIPLEX
+#error "SPI display backends use PB4 and PB5, build with -DSTATUS_LEDS=0 (Lock LED only)"
+#endif
+
 //Status pin bitmask
-static const uint8_t kStatusPinMask      = 0x23;
+#if STATUS_LEDS
+static const uint8_t kStatusPinMask      = 0x32;
+#else
+static const uint8_t kStatusPinMask      = 0x02;
+#endif
 
 //Status output register
 #define PWM_OUTPUT_REG PORTB
@@ -75,7 +165,81 @@ static const uint8_t kStatusPinMask      = 0x23;
 static const uint8_t kPwmPinMask      = 0x04;
 
 
-//OneWire PB3
-//Option PB4
+/* OneWire DS18B20 PB3, PD2 with an SPI display backend (PB3 is MOSI) */
+//OneWire registers
+#if DISPLAY_BACKEND == DISPLAY_BACKEND_MULTIPLEX
+#define ONEWIRE_INPUT_REG   PINB
+#define ONEWIRE_DIR_REG     DDRB
+#define ONEWIRE_OUTPUT_REG  PORTB
+
+static const uint8_t kOneWirePinMask = _BV(3);
+#else
+#define ONEWIRE_INPUT_REG   PIND
+#define ONEWIRE_DIR_REG     DDRD
+#define ONEWIRE_OUTPUT_REG  PORTD
+
+static const uint8_t kOneWirePinMask = _BV(2);
+#endif
+
+
+
+/* Mains zero-cross input PB0 (ICP1), one rising edge per mains cycle */
+//Mains input registers
+#define MAINS_INPUT_DIR_REG     DDRB
+#define MAINS_INPUT_OUTPUT_REG  PORTB
+
+static const uint8_t kMainsInputPinMask = _BV(0);
+
+//Mains Timer Configuration (free running, input capture and timeout compare)
+#define MAINS_TIMER_CONFIG_A_REG        TCCR1A
+#define MAINS_TIMER_CONFIG_B_REG        TCCR1B
+#define MAINS_TIMER_INTERRUPT_MASK_REG  TIMSK1
+#define MAINS_TIMER_COUNT_REG           TCNT1
+#define MAINS_TIMER_CAPTURE_REG         ICR1
+#define MAINS_TIMER_COMPARE_REG         OCR1A
+
+//Smallest prescaler fitting a 40Hz period in the 16 bit timer
+#if F_CPU / 8 / 40 <= 0xffff
+#define MAINS_TIMER_PRESCALER 8
+static const uint8_t kMainsTimerConfig = (_BV(ICNC1) | _BV(ICES1) | _BV(CS11)); //Noise canceler, rising edge, F_CPU/8
+#else
+#define MAINS_TIMER_PRESCALER 64
+static const uint8_t kMainsTimerConfig = (_BV(ICNC1) | _BV(ICES1) | _BV(CS11) | _BV(CS10)); //Noise canceler, rising edge, F_CPU/64
+#endif
+static const uint8_t kMainsTimerInterruptMask = (_BV(ICIE1) | _BV(OCIE1A));
+
+
+
+/* Watchdog, interrupt and system reset mode */
+//Watchdog registers
+#define WATCHDOG_CONTROL_REG       WDTCSR
+#define WATCHDOG_RESET_STATUS_REG  MCUSR
+
+#define WATCHDOG_TIMEOUT WDTO_1S
+static const uint8_t kWatchdogInterrupt = _BV(WDIE);
+static const uint8_t kWatchdogResetWatchdog = _BV(WDRF);
+static const uint8_t kWatchdogResetBrownout = _BV(BORF);
+static const uint8_t kWatchdogResetPowerOn = _BV(PORF);
+
+
+
+#if HWPROFILE_UART
+
+/* UART TXD PD1, shared with the display char outputs of the multiplex backend */
+//UART registers
+#define UART_BAUD_HIGH_REG  UBRR0H
+#define UART_BAUD_LOW_REG   UBRR0L
+#define UART_STATUS_REG     UCSR0A
+#define UART_CONTROL_REG    UCSR0B
+#define UART_FORMAT_REG     UCSR0C
+#define UART_DATA_REG       UDR0
+
+static const uint8_t kUartDoubleSpeed = _BV(U2X0);
+static const uint8_t kUartTransmitEnable = _BV(TXEN0);
+static const uint8_t kUartDataRegisterEmpty = _BV(UDRE0);
+static const uint8_t kUartTransmitComplete = _BV(TXC0);
+static const uint8_t kUartFormat = (_BV(UCSZ01) | _BV(UCSZ00)); //8N1
+
+#endif
 
 #endif
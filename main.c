@@ -1,32 +1,57 @@
 #include "display.h"
 #include "encoder.h"
+#include "eventlog.h"
+#include "mains.h"
 #include "pwm.h"
 #include "settings.h"
 #include "status.h"
+#include "temperature.h"
+#include "trace.h"
 #include "ui.h"
+#include "watchdog.h"
 
 int main(void)
 {
+  //Output is already forced off by watchdog_early_init()
+  trace_init(watchdog_reset_flags());
   pwm_init();
+  watchdog_init();
   status_init();
   display_init();
   encoder_init();
+  trace_record(kTraceBoot, watchdog_reset_flags());
+  eventlog_init();
+  eventlog_record(kEventLogBoot, watchdog_reset_flags());
 
   struct BoilPowerSettings systemSettings;
   settings_load(&systemSettings);
   
   //Check settings validity launching settings UI Menu if necessary
-  if (settings_init(&systemSettings) || encoder_raw_enter()) {
+  uint8_t invalid = settings_init(&systemSettings);
+  mains_init(systemSettings.data.frequency);
+  temperature_init();
+
+  //Report the fault behind the last reset, power stays off until selected again
+  if (watchdog_fault()) {
+    trace_record(kTraceFault, watchdog_fault());
+    eventlog_record(kEventLogFault, watchdog_fault());
+    ui_show_fault(watchdog_fault());
+  }
+
+  if (invalid || encoder_raw_enter()) {
     ui_setup(&systemSettings);
     settings_save(&systemSettings);
   }
 
   ui_init(&systemSettings);
-  pwm_set_period(systemSettings.data.period * 100);
   
   while (1) {
     ui_update();
     pwm_update();
+    display_update();
+    eventlog_update();
+    trace_update();
+    watchdog_update();
   }
 }
 
@@ -0,0 +1,172 @@
+#include "mains.h"
+
+#include <avr/interrupt.h>
+#include <util/atomic.h> 
+
+#include "hwprofile.h"
+#include "watchdog.h"
+
+//Mains timer counts per second
+#define MAINS_TIMER_HZ (F_CPU / MAINS_TIMER_PRESCALER)
+
+//Accepted mains periods (70Hz to 40Hz)
+static const uint16_t kMainsMinPeriod = MAINS_TIMER_HZ / 70;
+static const uint16_t kMainsMaxPeriod = MAINS_TIMER_HZ / 40;
+
+//Consecutive consistent periods required to lock
+static const uint8_t kMainsLockCount = 8;
+
+//Consecutive missing edges tolerated before the signal is considered lost
+static const uint8_t kMainsMaxMissed = 8;
+
+//Lock state and cycle counter
+static volatile uint8_t gMainsLocked = 0;
+static volatile uint16_t gMainsCycles = 0;
+
+//Running sum of the last 8 periods (exponential), average = sum / 8
+static volatile uint32_t gMainsPeriodSum = 0;
+
+//Locked: timer value of the last cycle boundary (real or substituted for a missing edge)
+static volatile uint16_t gMainsLastTick = 0;
+static volatile uint8_t gMainsMissed = 0;
+
+//Unlocked: timer value and period of the last edge while acquiring
+static volatile uint16_t gMainsLastEdge = 0;
+static volatile uint16_t gMainsLastPeriod = 0;
+static volatile uint8_t gMainsGoodCount = 0;
+
+//Cycle period used while unlocked
+static volatile uint16_t gMainsFallbackPeriod = MAINS_TIMER_HZ / 60;
+static uint8_t gMainsFallbackFrequency = 60;
+
+//Frequency computed for the last average read
+static uint16_t gMainsCachedAverage = 0;
+static uint8_t gMainsCachedFrequency = 0;
+
+void mains_init(uint8_t fallbackFrequency)
+{
+  //Zero-cross input with pull-up for open collector detectors
+  MAINS_INPUT_DIR_REG &= ~kMainsInputPinMask;
+  MAINS_INPUT_OUTPUT_REG |= kMainsInputPinMask;
+
+  mains_set_fallback(fallbackFrequency);
+  MAINS_TIMER_CONFIG_A_REG = 0;                                    //Normal mode, timer free running
+  MAINS_TIMER_COMPARE_REG = MAINS_TIMER_COUNT_REG + gMainsFallbackPeriod;
+  MAINS_TIMER_INTERRUPT_MASK_REG |= kMainsTimerInterruptMask;      //Enable capture and compare interrupts
+  MAINS_TIMER_CONFIG_B_REG = kMainsTimerConfig;                    //Set capture edge and timer prescaler
+  sei();                                                           //Enable global interrupts 
+}
+
+void mains_set_fallback(uint8_t fallbackFrequency)
+{
+  if (!fallbackFrequency)
+    return;
+  //Periods longer than the timer range (below ~16Hz at 1MHz) are clamped
+  uint32_t period = MAINS_TIMER_HZ / fallbackFrequency;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    gMainsFallbackPeriod = period > 0xffff ? 0xffff : period;
+  }
+  gMainsFallbackFrequency = fallbackFrequency;
+}
+
+uint8_t mains_locked(void)
+{
+  return gMainsLocked;
+}
+
+uint8_t mains_frequency(void)
+{
+  if (!gMainsLocked)
+    return gMainsFallbackFrequency;
+  uint16_t average;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    average = gMainsPeriodSum >> 3;
+  }
+  //Only divide when the average has moved
+  if (average != gMainsCachedAverage) {
+    gMainsCachedAverage = average;
+    gMainsCachedFrequency = (MAINS_TIMER_HZ + average / 2) / average;
+  }
+  return gMainsCachedFrequency;
+}
+
+uint16_t mains_cycles(void)
+{
+  uint16_t cycles;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    cycles = gMainsCycles;
+  }
+  return cycles;
+}
+
+ISR(TIMER1_CAPT_vect)
+{
+  uint16_t capture = MAINS_TIMER_CAPTURE_REG;
+
+  if (gMainsLocked) {
+    uint16_t average = gMainsPeriodSum >> 3;
+    uint16_t period = capture - gMainsLastTick;
+    //Edges well ahead of the expected one are glitches
+    if (period < average - (average >> 3))
+      return;
+    //Only real edges prove sensing alive, the compare keeps counting without any
+    watchdog_checkin(kWatchdogSensing);
+    //Only clean periods between two real edges feed the average
+    if (!gMainsMissed && period <= average + (average >> 3))
+      gMainsPeriodSum = gMainsPeriodSum - average + period;
+    gMainsMissed = 0;
+    gMainsLastTick = capture;
+    //Substitute a cycle if the next edge is more than half a period late
+    MAINS_TIMER_COMPARE_REG = capture + average + (average >> 1);
+    ++gMainsCycles;
+    return;
+  }
+
+  //Acquiring, count consecutive periods in range that agree within 1/8
+  uint16_t period = capture - gMainsLastEdge;
+  if (period < kMainsMinPeriod)
+    return;
+  gMainsLastEdge = capture;
+  uint16_t lastPeriod = gMainsLastPeriod;
+  gMainsLastPeriod = period;
+  if (period > kMainsMaxPeriod) {
+    gMainsGoodCount = 0;
+    return;
+  }
+  watchdog_checkin(kWatchdogSensing);
+  if (!gMainsGoodCount || period < lastPeriod - (lastPeriod >> 3) || period > lastPeriod + (lastPeriod >> 3)) {
+    gMainsGoodCount = 1;
+    gMainsPeriodSum = (uint32_t)period << 3;
+    return;
+  }
+  gMainsPeriodSum = gMainsPeriodSum - (gMainsPeriodSum >> 3) + period;
+  if (++gMainsGoodCount < kMainsLockCount)
+    return;
+
+  //Locked, cycles are counted from edges from here on
+  gMainsLocked = 1;
+  gMainsMissed = 0;
+  gMainsLastTick = capture;
+  uint16_t average = gMainsPeriodSum >> 3;
+  MAINS_TIMER_COMPARE_REG = capture + average + (average >> 1);
+}
+
+ISR(TIMER1_COMPA_vect)
+{
+  if (gMainsLocked) {
+    if (++gMainsMissed > kMainsMaxMissed) {
+      //Signal lost, count cycles at the fallback frequency
+      gMainsLocked = 0;
+      gMainsGoodCount = 0;
+      MAINS_TIMER_COMPARE_REG += gMainsFallbackPeriod;
+    } else {
+      //Expected edge missing, count the cycle it should have ended keeping the phase
+      uint16_t average = gMainsPeriodSum >> 3;
+      gMainsLastTick += average;
+      MAINS_TIMER_COMPARE_REG = gMainsLastTick + average + (average >> 1);
+    }
+  } else {
+    MAINS_TIMER_COMPARE_REG += gMainsFallbackPeriod;
+  }
+  ++gMainsCycles;
+}
@@ -0,0 +1,23 @@
+#ifndef BOILPOWER_MAINS_H_
+#define BOILPOWER_MAINS_H_
+
+#include <stdint.h>
+#include <avr/io.h> 
+
+//Start mains period measurement, frequency in Hz is used while no signal is present
+void mains_init(uint8_t fallbackFrequency);
+
+//Change the frequency used while no signal is present
+void mains_set_fallback(uint8_t fallbackFrequency);
+
+//Returns 1 while locked to a zero-cross signal
+uint8_t mains_locked(void);
+
+//Measured frequency in Hz when locked, fallback frequency otherwise
+uint8_t mains_frequency(void);
+
+//Free running mains cycle counter, counts at the fallback frequency while no signal is present
+//Checks in with the watchdog whenever the count has moved since the last call
+uint16_t mains_cycles(void);
+
+#endif
@@ -0,0 +1,86 @@
+#include "onewire.h"
+
+#include <util/atomic.h> 
+#include <util/delay.h>
+
+#include "hwprofile.h"
+
+//Bus is driven low through the direction bit only, the output bit stays 0 (open drain)
+#define ONEWIRE_LOW()     (ONEWIRE_DIR_REG |= kOneWirePinMask)
+#define ONEWIRE_RELEASE() (ONEWIRE_DIR_REG &= ~kOneWirePinMask)
+#define ONEWIRE_READ()    (ONEWIRE_INPUT_REG & kOneWirePinMask)
+
+void onewire_write_bit(uint8_t bit);
+uint8_t onewire_read_bit(void);
+
+void onewire_init(void)
+{
+  ONEWIRE_OUTPUT_REG &= ~kOneWirePinMask;
+  ONEWIRE_RELEASE();
+}
+
+uint8_t onewire_reset(void)
+{
+  uint8_t presence;
+  //Reset pulse may be stretched by interrupts, presence sampling may not
+  ONEWIRE_LOW();
+  _delay_us(480);
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    ONEWIRE_RELEASE();
+    _delay_us(70);
+    presence = !ONEWIRE_READ();
+  }
+  _delay_us(410);
+  return presence;
+}
+
+void onewire_write_bit(uint8_t bit)
+{
+  //Time slots are timing critical, interrupts are held off for one slot (~70us)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    ONEWIRE_LOW();
+    if (bit) {
+      _delay_us(6);
+      ONEWIRE_RELEASE();
+      _delay_us(64);
+    } else {
+      _delay_us(60);
+      ONEWIRE_RELEASE();
+      _delay_us(10);
+    }
+  }
+}
+
+uint8_t onewire_read_bit(void)
+{
+  uint8_t bit;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    ONEWIRE_LOW();
+    _delay_us(6);
+    ONEWIRE_RELEASE();
+    _delay_us(9);
+    bit = ONEWIRE_READ() ? 1 : 0;
+  }
+  _delay_us(55);
+  return bit;
+}
+
+void onewire_write_byte(uint8_t data)
+{
+  //LSB first
+  for (uint8_t i = 0; i < 8; ++i) {
+    onewire_write_bit(data & 0x01);
+    data >>= 1;
+  }
+}
+
+uint8_t onewire_read_byte(void)
+{
+  uint8_t data = 0;
+  for (uint8_t i = 0; i < 8; ++i) {
+    data >>= 1;
+    if (onewire_read_bit())
+      data |= 0x80;
+  }
+  return data;
+}
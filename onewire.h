@@ -0,0 +1,16 @@
+#ifndef BOILPOWER_ONEWIRE_H_
+#define BOILPOWER_ONEWIRE_H_
+
+#include <stdint.h>
+#include <avr/io.h> 
+
+//Release the bus (external 4k7 pull-up)
+void onewire_init(void);
+
+//Reset pulse, returns 1 if a device answered with a presence pulse
+uint8_t onewire_reset(void);
+
+void onewire_write_byte(uint8_t data);
+uint8_t onewire_read_byte(void);
+
+#endif
@@ -1,12 +1,41 @@
 #include "pwm.h"
 
-#include "display.h" //Provides millis()
+#include <avr/io.h>
+
+#include "calcs.h"
 #include "hwprofile.h"
+#include "mains.h"
 #include "status.h"
+#include "trace.h"
+#include "watchdog.h"
 
+//Requested period and level in mains cycles, timed against mains_cycles()
 static uint16_t gPwmPeriod = 0;
 static uint16_t gPwmLevel = 0;
-static uint32_t gPwmPeriodStart = 0;
+static uint16_t gPwmPeriodStart = 0;
+static uint8_t gPwmActive = 0;
+
+//Level allowed by the ramp limiter, moves toward gPwmLevel once per period
+static uint16_t gPwmRampLevel = 0;
+static uint16_t gPwmRampStep = 0;    //Cycles per period, 0 = no limit
+static uint16_t gPwmRampStart = 0;
+static uint8_t gPwmRampPercent = 0;
+static uint8_t gPwmInrush = 0;
+
+//Period and level applied to the running period and the ones taking over at its end
+static uint16_t gPwmEffectivePeriod = 0;
+static uint16_t gPwmEffectiveLevel = 0;
+static uint16_t gPwmNextPeriod = 0;
+static uint16_t gPwmNextLevel = 0;
+static uint8_t gPwmAdaptive = 0;
+
+//Output edges still traced since the last level or period change, steady output would flush the trace
+static const uint8_t kPwmTraceEdges = 4;
+static uint8_t gPwmTraceEdges = 0;
+
+void pwm_prepare(uint8_t decrease);
+void pwm_ramp(void);
+uint16_t pwm_rescale(uint16_t level, uint16_t period);
 
 void pwm_init()
 {
@@ -16,17 +45,57 @@ void pwm_init()
 
 void pwm_set_period(uint16_t period)
 {
+  //Rescale the requested and ramped levels, a running output neither restarts its ramp nor its inrush cycle
+  if (gPwmPeriod) {
+    gPwmLevel = pwm_rescale(gPwmLevel, period);
+    gPwmRampLevel = pwm_rescale(gPwmRampLevel, period);
+  }
   gPwmPeriod = period;
-  gPwmLevel = 0;
-  gPwmPeriodStart = millis();
+  pwm_set_ramp(gPwmRampPercent, gPwmInrush);
+  //The running period finishes on its old level, the new period starts at its boundary
+  uint16_t effectiveLevel = gPwmEffectiveLevel;
+  pwm_prepare(0);
+  gPwmEffectiveLevel = effectiveLevel;
+}
+
+uint16_t pwm_rescale(uint16_t level, uint16_t period)
+{
+  uint16_t scaled = ((uint32_t)level * period + gPwmPeriod / 2) / gPwmPeriod;
+  return level && !scaled ? 1 : scaled;
+}
+
+void pwm_set_adaptive(uint8_t adaptive)
+{
+  gPwmAdaptive = adaptive;
+  pwm_prepare(0);
+}
+
+void pwm_set_ramp(uint8_t percent, uint8_t inrush)
+{
+  gPwmRampPercent = percent;
+  gPwmInrush = inrush;
+  gPwmRampStep = (uint32_t)gPwmPeriod * percent / 100;
+  if (percent && !gPwmRampStep)
+    gPwmRampStep = 1;
 }
 
 void pwm_update(void)
 {
-  uint32_t timestamp = millis();
-  if (timestamp > gPwmPeriodStart + gPwmPeriod)
-    gPwmPeriodStart = timestamp;
-  if (timestamp < gPwmPeriodStart + gPwmLevel) {
+  watchdog_checkin(kWatchdogPwm);
+  uint16_t cycle = mains_cycles();
+  if ((uint16_t)(cycle - gPwmPeriodStart) >= gPwmEffectivePeriod) {
+    gPwmPeriodStart = cycle;
+    //Ramp steps are a full requested period apart, even with shorter adaptive periods
+    if (gPwmRampLevel < gPwmLevel && (uint16_t)(cycle - gPwmRampStart) >= gPwmPeriod)
+      pwm_ramp();
+    //Period changes only take effect on period boundaries
+    if (gPwmNextPeriod != gPwmEffectivePeriod)
+      trace_record(kTracePwmPeriod, gPwmNextPeriod > 0xff ? 0xff : gPwmNextPeriod);
+    gPwmEffectivePeriod = gPwmNextPeriod;
+    gPwmEffectiveLevel = gPwmNextLevel;
+  }
+  uint8_t active = (uint16_t)(cycle - gPwmPeriodStart) < gPwmEffectiveLevel;
+  if (active) {
     //PWM Active
     PWM_OUTPUT_REG |= kPwmPinMask;
     status_set(kStatusHeat);
@@ -35,14 +104,81 @@ void pwm_update(void)
     PWM_OUTPUT_REG &= ~kPwmPinMask;
     status_clear(kStatusHeat);
   }
+  if (active != gPwmActive) {
+    gPwmActive = active;
+    if (gPwmTraceEdges) {
+      --gPwmTraceEdges;
+      trace_record(kTracePwm, active);
+    }
+  }
 }
 
 void pwm_set_level(uint16_t level)
 {
+  //Nothing to prepare, ie the level was already rescaled with the period
+  if (level == gPwmLevel)
+    return;
   gPwmLevel = level;
+  if (level <= gPwmRampLevel) {
+    //Decreases and Off bypass the limiter
+    uint8_t decrease = level < gPwmRampLevel;
+    gPwmRampLevel = level;
+    pwm_prepare(decrease);
+  } else if (!gPwmRampLevel) {
+    //Nothing is being output, a new period starts now so the first step runs in full
+    gPwmPeriodStart = mains_cycles();
+    gPwmEffectivePeriod = 0;
+    pwm_ramp();
+  } else if (!gPwmRampStep) {
+    //Unlimited increases apply right away
+    pwm_ramp();
+  }
+  //Limited increases take a step at each following period boundary
+}
+
+void pwm_ramp(void)
+{
+  if (!gPwmRampLevel && gPwmInrush)
+    gPwmRampLevel = 1; //Inrush policy, a single cycle first after Off
+  else if (gPwmRampStep && gPwmLevel - gPwmRampLevel > gPwmRampStep)
+    gPwmRampLevel += gPwmRampStep;
+  else
+    gPwmRampLevel = gPwmLevel;
+  //Anchored to the running period's start, the next step lands on the next period boundary
+  gPwmRampStart = gPwmPeriodStart;
+  pwm_prepare(0);
+}
+
+void pwm_prepare(uint8_t decrease)
+{
+  gPwmTraceEdges = kPwmTraceEdges;
+  uint16_t level = gPwmRampLevel;
+  if (!gPwmAdaptive) {
+    //Fixed period, the level applies right away
+    gPwmNextPeriod = gPwmPeriod;
+    gPwmNextLevel = gPwmEffectiveLevel = level;
+    return;
+  }
+  //Shortest period holding the same on/off ratio in whole cycles (ie 30/60 -> 1/2)
+  uint16_t divisor = calcs_gcd(gPwmPeriod, level);
+  if (!divisor)
+    return;
+  gPwmNextPeriod = gPwmPeriod / divisor;
+  gPwmNextLevel = level / divisor;
+  //Decreases cut the running period to the new ratio in whole cycles, the new period starts at its boundary
+  if (decrease) {
+    uint16_t limit = (uint32_t)gPwmNextLevel * gPwmEffectivePeriod / gPwmNextPeriod;
+    if (limit < gPwmEffectiveLevel)
+      gPwmEffectiveLevel = limit;
+  }
 }
 
 uint16_t pwm_period()
 {
   return gPwmPeriod;
-}
\ No newline at end of file
+}
+
+uint16_t pwm_effective_period()
+{
+  return gPwmEffectivePeriod;
+}
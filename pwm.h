@@ -6,16 +6,26 @@
 //Initialize PWM logic
 void pwm_init(void);
 
-//Configure PWM period
+//Configure PWM period in mains cycles, a running level is rescaled and the new period starts at the next boundary
 void pwm_set_period(uint16_t period);
 
 //Update PWM logic
 void pwm_update(void);
 
-//Set the PWM on time in ms
+//Set the PWM on time in mains cycles
 void pwm_set_level(uint16_t level);
 
 //Get the PWM Period
 uint16_t pwm_period(void);
 
+//Limit increases to percent of the period per period (0 = no limit)
+//inrush: the first period after Off runs a single cycle
+void pwm_set_ramp(uint8_t percent, uint8_t inrush);
+
+//Pick the shortest period representing the level exactly in whole cycles
+void pwm_set_adaptive(uint8_t adaptive);
+
+//Get the period in mains cycles currently being output (shorter than pwm_period() in adaptive mode)
+uint16_t pwm_effective_period(void);
+
 #endif
@@ -3,48 +3,60 @@
 #include <util/crc16.h>
 #include <avr/eeprom.h>
 
-struct BoilPowerSettings EEMEM eepromSettings;
+#include "display.h"
+#include "eventlog.h"
+#include "trace.h"
 
-uint8_t settings_crc(struct BoilPowerSettingsData *data);
+struct BoilPowerSettings EEMEM eepromSettings;
 
 uint8_t settings_init(struct BoilPowerSettings *settings)
 {
   if (
     settings->header.version == kSettingsVersion &&
-    settings->header.size == sizeof(settings) &&
+    settings->header.size == sizeof(*settings) &&
     settings->header.crc == settings_crc(&settings->data)
   )
     return 0;
 
   settings->header.version = kSettingsVersion;
-  settings->header.size = sizeof(settings);
+  settings->header.size = sizeof(*settings);
   settings->data.period = 10;      //1.0s (60 clicks @ 60Hz, 50 @ 50Hz)
   settings->data.sensitivity = 1;  //1 click ~ 1 Cycle
   settings->data.frequency = 60;   //60Hz
   settings->data.userSetpoint[0] = 0;
   settings->data.userSetpoint[1] = 0;
   settings->data.userSetpoint[2] = 0;
+  settings->data.hotLock = 0;
+  settings->data.adaptive = 0;
+  settings->data.rampStep = 0;
+  settings->data.inrush = 0;
+  settings->data.boilLevel = 0;
+  settings->data.altitude = 0;
+  settings->data.brightness = DISPLAY_BRIGHTNESS_MAX;
+  settings->data.dimLevel = 2;
+  settings->data.dimTimeout = 60;  //1 minute
   return(1);
 }
 
 void settings_load(struct BoilPowerSettings *settings)
 {
-  eeprom_read_block((void*)settings, (const void*)&eepromSettings, sizeof(settings)); 
+  eeprom_read_block((void*)settings, (const void*)&eepromSettings, sizeof(*settings)); 
 }
 
 void settings_save(struct BoilPowerSettings *settings)
 {
   settings->header.crc = settings_crc(&settings->data);
+  trace_record(kTraceSettings, settings->header.crc);
+  eventlog_record(kEventLogSettings, settings->header.crc);
   eeprom_update_block((void*)settings, (void*)&eepromSettings, sizeof(eepromSettings)); 
 }
 
 uint8_t settings_crc(struct BoilPowerSettingsData *data)
 {
-  //TODO Fix CRC
   uint8_t crc = 0;
   uint8_t* chunk = (uint8_t*) data;
   
-  for (uint8_t i = 0; i < sizeof(data); i++)
+  for (uint8_t i = 0; i < sizeof(*data); i++)
     crc = _crc_ibutton_update(crc, *chunk++);
-  return crc; // must be 0
+  return crc;
 }
\ No newline at end of file
@@ -3,7 +3,7 @@
 
 #include <stdint.h>
 
-static const uint8_t kSettingsVersion = 1;
+static const uint8_t kSettingsVersion = 6;
 
 struct BoilPowerSettingsHeader {
   uint8_t version;
@@ -15,8 +15,16 @@ struct BoilPowerSettingsData {
   uint8_t period;           //Time in tenths of seconds of the entire period
   uint8_t sensitivity;      //Number of cycles per encoder click
   uint8_t frequency;        //Frequency in Hz of a single pulse
-  uint8_t userSetpoint[3];  //User defined setpoints (0 = disabled)
+  uint8_t userSetpoint[3];  //User defined setpoints in percent, independent of the mains frequency (0 = disabled)
   uint8_t hotLock;          //Allows Lock with output active
+  uint8_t adaptive;         //Shortens the period to the level's whole cycle ratio
+  uint8_t rampStep;         //Maximum power increase per period in percent (0 = no limit)
+  uint8_t inrush;           //Runs a single cycle in the first period after Off
+  uint8_t boilLevel;        //User setpoint (1-3) applied when a boil is detected (0 = off)
+  uint8_t altitude;         //Altitude in 100m for the boil point
+  uint8_t brightness;       //Display brightness, 1 (dimmest) to DISPLAY_BRIGHTNESS_MAX
+  uint8_t dimLevel;         //Display brightness after dimTimeout without input
+  uint8_t dimTimeout;       //Seconds without input before the display dims (0 = never)
 };
 
 struct BoilPowerSettings {
@@ -29,4 +37,7 @@ uint8_t settings_init(struct BoilPowerSettings *settings);
 void settings_load(struct BoilPowerSettings *settings);
 void settings_save(struct BoilPowerSettings *settings);
 
+//Checksum of the settings data as stored in the header
+uint8_t settings_crc(struct BoilPowerSettingsData *data);
+
 #endif
\ No newline at end of file
@@ -5,9 +5,10 @@
 #include <avr/io.h> 
  
 //Status port bit mapping
-static const uint8_t kStatusHeat   = _BV(0);
+static const uint8_t kStatusHeat   = _BV(4);  //STATUS_LEDS builds only (PB4 is MISO with SPI)
 static const uint8_t kStatusLock = _BV(1);
 static const uint8_t kStatusDebug = _BV(5);
+static const uint8_t kStatusBoil = _BV(5);  //Shares the debug LED, STATUS_LEDS builds only
  
 //Function Declarations
 void status_init(void);
@@ -0,0 +1,111 @@
+#include "temperature.h"
+
+#include <util/crc16.h>
+
+#include "display.h" //Provides millis16()
+#include "eventlog.h"
+#include "onewire.h"
+#include "watchdog.h"
+
+//DS18B20 commands (single probe on the bus)
+static const uint8_t kTemperatureSkipRom = 0xcc;
+static const uint8_t kTemperatureConvert = 0x44;
+static const uint8_t kTemperatureReadScratchpad = 0xbe;
+
+//Time from starting a conversion to reading the result (12 bit resolution)
+static const uint16_t kTemperatureConversionTime = 750;
+
+enum TemperatureState {
+  kTemperatureStateIdle,
+  kTemperatureStateConverting
+};
+
+static uint8_t gTemperatureState = kTemperatureStateIdle;
+static uint16_t gTemperatureTime = 0;
+static uint8_t gTemperatureValid = 0;
+static int16_t gTemperatureValue = 0;
+
+uint8_t temperature_read(int16_t *value);
+void temperature_set_valid(uint8_t valid);
+
+void temperature_init(void)
+{
+  onewire_init();
+  gTemperatureState = kTemperatureStateIdle;
+  gTemperatureTime = millis16() - TEMPERATURE_SAMPLE_INTERVAL; //Start the first conversion straight away
+}
+
+uint8_t temperature_update(void)
+{
+  uint16_t elapsed = millis16() - gTemperatureTime;
+
+  switch (gTemperatureState) {
+    case kTemperatureStateIdle:
+      if (elapsed < TEMPERATURE_SAMPLE_INTERVAL)
+        return 0;
+      gTemperatureTime += TEMPERATURE_SAMPLE_INTERVAL;
+      if (elapsed >= 2 * TEMPERATURE_SAMPLE_INTERVAL)
+        gTemperatureTime = millis16(); //Fell behind, don't try to catch up
+      if (!onewire_reset()) {
+        temperature_set_valid(0);
+        return 0;
+      }
+      onewire_write_byte(kTemperatureSkipRom);
+      onewire_write_byte(kTemperatureConvert);
+      gTemperatureState = kTemperatureStateConverting;
+      return 0;
+
+    case kTemperatureStateConverting:
+      if (elapsed < kTemperatureConversionTime)
+        return 0;
+      gTemperatureState = kTemperatureStateIdle;
+      int16_t value;
+      if (!temperature_read(&value)) {
+        temperature_set_valid(0);
+        return 0;
+      }
+      gTemperatureValue = value;
+      temperature_set_valid(1);
+      watchdog_checkin(kWatchdogSensing);
+      return 1;
+  }
+  return 0;
+}
+
+uint8_t temperature_valid(void)
+{
+  return gTemperatureValid;
+}
+
+int16_t temperature_value(void)
+{
+  return gTemperatureValue;
+}
+
+uint8_t temperature_read(int16_t *value)
+{
+  uint8_t scratchpad[9];
+  uint8_t crc = 0;
+
+  if (!onewire_reset())
+    return 0;
+  onewire_write_byte(kTemperatureSkipRom);
+  onewire_write_byte(kTemperatureReadScratchpad);
+  for (uint8_t i = 0; i < sizeof(scratchpad); ++i) {
+    scratchpad[i] = onewire_read_byte();
+    crc = _crc_ibutton_update(crc, scratchpad[i]);
+  }
+
+  //Crc over all 9 bytes is 0, the fixed config bits reject an all zero read (shorted bus)
+  if (crc || (scratchpad[4] & 0x9f) != 0x1f)
+    return 0;
+  *value = (int16_t)((uint16_t)scratchpad[1] << 8 | scratchpad[0]);
+  return 1;
+}
+
+void temperature_set_valid(uint8_t valid)
+{
+  if (gTemperatureValid && !valid)
+    eventlog_record(kEventLogProbeLost, 0);
+  gTemperatureValid = valid;
+}
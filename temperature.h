@@ -0,0 +1,21 @@
+#ifndef BOILPOWER_TEMPERATURE_H_
+#define BOILPOWER_TEMPERATURE_H_
+
+#include <stdint.h>
+
+//Sample interval of the DS18B20 in milliseconds (12 bit conversion takes 750ms)
+#define TEMPERATURE_SAMPLE_INTERVAL 1000
+
+//Start sampling the OneWire temperature probe
+void temperature_init(void);
+
+//Run the conversion state machine, returns 1 when a new sample was read, call from the main loop
+uint8_t temperature_update(void);
+
+//Returns 1 while the probe answers with valid samples
+uint8_t temperature_valid(void);
+
+//Last valid sample in 1/16 degrees C
+int16_t temperature_value(void);
+
+#endif
@@ -0,0 +1,52 @@
+//Host test for the boil detector in boil.c
+//
+//A short dip leaves a negative heating rate behind. It must decay back to 0 once the
+//temperature holds, or the plateau below the boil point is never detected.
+//Exit status is 0 when all cases pass.
+
+#include <stdio.h>
+
+#include "boil.h"
+
+//Feed samples at temperature until a boil is reported, returns the samples it took (0 = none)
+static unsigned boil_test_hold(int16_t temperature, unsigned samples)
+{
+  for (unsigned i = 1; i <= samples; ++i)
+    if (boil_update(temperature))
+      return i;
+  return 0;
+}
+
+static unsigned boil_test_dip(int16_t start, int16_t step, uint8_t dipSamples)
+{
+  boil_init(0);
+  int16_t temperature = start;
+  boil_update(temperature);
+  for (uint8_t i = 0; i < dipSamples; ++i) {
+    temperature -= step;
+    if (boil_update(temperature))
+      return 0;
+  }
+  return boil_test_hold(temperature, 1000);
+}
+
+int main(void)
+{
+  unsigned failures = 0;
+  //Temperatures in 1/16 C, the boil point at sea level is 1600
+  static const struct {
+    int16_t start, step;
+    uint8_t dipSamples;
+  } kCases[] = {{1590, 0, 0}, {1590, 1, 1}, {1590, 2, 10}, {1596, 1, 20}, {1599, 20, 1}};
+
+  for (unsigned i = 0; i < sizeof(kCases) / sizeof(kCases[0]); ++i) {
+    unsigned samples = boil_test_dip(kCases[i].start, kCases[i].step, kCases[i].dipSamples);
+    printf("%s dip of %d x %u from %d: ", samples ? "ok  " : "FAIL", kCases[i].step, kCases[i].dipSamples, kCases[i].start);
+    if (samples)
+      printf("boil after %u samples\n", samples);
+    else
+      printf("no boil\n");
+    failures += !samples;
+  }
+  return failures ? 1 : 0;
+}
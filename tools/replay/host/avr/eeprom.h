@@ -0,0 +1,48 @@
+#ifndef BOILPOWER_HOST_AVR_EEPROM_H_
+#define BOILPOWER_HOST_AVR_EEPROM_H_
+
+//Host stand-in for <avr/eeprom.h>, EEMEM variables live in RAM
+//Plain EEPROM addresses (0..E2END, cast to pointers) map into gHostEeprom
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define EEMEM
+
+#define eeprom_is_ready() 1
+
+//Maps plain EEPROM addresses into host memory, other pointers are returned as they are (see registers.c)
+void *host_eeprom_address(const void *address);
+
+static inline void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+  memcpy(dst, host_eeprom_address(src), n);
+}
+
+static inline void eeprom_update_block(const void *src, void *dst, size_t n)
+{
+  memcpy(host_eeprom_address(dst), src, n);
+}
+
+static inline uint8_t eeprom_read_byte(const uint8_t *address)
+{
+  return *(uint8_t *)host_eeprom_address(address);
+}
+
+static inline void eeprom_update_byte(uint8_t *address, uint8_t value)
+{
+  *(uint8_t *)host_eeprom_address(address) = value;
+}
+
+static inline uint16_t eeprom_read_word(const uint16_t *address)
+{
+  return *(uint16_t *)host_eeprom_address(address);
+}
+
+static inline void eeprom_update_word(uint16_t *address, uint16_t value)
+{
+  *(uint16_t *)host_eeprom_address(address) = value;
+}
+
+#endif
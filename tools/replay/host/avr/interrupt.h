@@ -0,0 +1,10 @@
+#ifndef BOILPOWER_HOST_AVR_INTERRUPT_H_
+#define BOILPOWER_HOST_AVR_INTERRUPT_H_
+
+//Host stand-in for <avr/interrupt.h>, ISRs become plain functions called by the harness
+
+#define ISR(vector, ...) void vector(void)
+#define sei()
+#define cli()
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef BOILPOWER_HOST_AVR_IO_H_
+#define BOILPOWER_HOST_AVR_IO_H_
+
+//Host stand-in for <avr/io.h>, I/O registers are plain memory (see registers.c)
+
+#include <stdint.h>
+
+//Stands in for an ATmega168 unless another supported MCU is defined (-D__AVR_ATtiny88__)
+#if !defined(__AVR_ATmega328P__) && !defined(__AVR_ATtiny88__)
+#define __AVR_ATmega168__
+#endif
+
+//Last EEPROM address
+#if defined(__AVR_ATtiny88__)
+#define E2END 0x3f
+#elif defined(__AVR_ATmega328P__)
+#define E2END 0x3ff
+#else
+#define E2END 0x1ff
+#endif
+
+#define _BV(bit) (1 << (bit))
+
+//Ports
+extern volatile uint8_t PINB, DDRB, PORTB;
+extern volatile uint8_t PINC, DDRC, PORTC;
+extern volatile uint8_t PIND, DDRD, PORTD;
+
+//Timer0
+extern volatile uint8_t TCCR0A, TCCR0B, TIMSK0, OCR0A, OCR0B;
+#define WGM01  1
+#define CTC0   3
+#define CS00   0
+#define CS01   1
+#define CS02   2
+#define OCIE0A 1
+#define OCIE0B 2
+
+//Timer1
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+extern volatile uint16_t TCNT1, ICR1, OCR1A;
+#define CS10   0
+#define CS11   1
+#define ICES1  6
+#define ICNC1  7
+#define OCIE1A 1
+#define ICIE1  5
+
+//Watchdog and reset flags
+extern volatile uint8_t WDTCSR, MCUSR;
+#define WDIE 6
+#define PORF  0
+#define EXTRF 1
+#define BORF  2
+#define WDRF  3
+
+//Pin change interrupts
+extern volatile uint8_t PCICR, PCMSK1;
+#define PCIE1   1
+#define PCINT8  0
+#define PCINT9  1
+#define PCINT10 2
+
+//SPI
+extern volatile uint8_t SPCR, SPSR, SPDR;
+#define SPR0  0
+#define SPR1  1
+#define MSTR  4
+#define SPE   6
+#define SPIE  7
+#define SPI2X 0
+#define SPIF  7
+
+//USART0
+extern volatile uint8_t UBRR0H, UBRR0L, UCSR0A, UCSR0B, UCSR0C, UDR0;
+#define U2X0   1
+#define UDRE0  5
+#define TXC0   6
+#define TXEN0  3
+#define UCSZ00 1
+#define UCSZ01 2
+
+#endif
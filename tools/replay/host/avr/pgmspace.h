@@ -0,0 +1,16 @@
+#ifndef BOILPOWER_HOST_AVR_PGMSPACE_H_
+#define BOILPOWER_HOST_AVR_PGMSPACE_H_
+
+//Host stand-in for <avr/pgmspace.h>, flash data is ordinary memory
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef BOILPOWER_HOST_AVR_WDT_H_
+#define BOILPOWER_HOST_AVR_WDT_H_
+
+//Host stand-in for <avr/wdt.h>, the watchdog never fires
+
+#define WDTO_1S 6
+
+#define wdt_enable(timeout)
+#define wdt_disable()
+#define wdt_reset()
+
+#endif
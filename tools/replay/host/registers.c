@@ -0,0 +1,23 @@
+#include <avr/io.h>
+#include <avr/eeprom.h>
+
+//Storage for the host I/O registers declared in avr/io.h
+volatile uint8_t PINB, DDRB, PORTB;
+volatile uint8_t PINC, DDRC, PORTC;
+volatile uint8_t PIND, DDRD, PORTD;
+volatile uint8_t TCCR0A, TCCR0B, TIMSK0, OCR0A, OCR0B;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+volatile uint16_t TCNT1, ICR1, OCR1A;
+volatile uint8_t WDTCSR, MCUSR;
+volatile uint8_t PCICR, PCMSK1;
+volatile uint8_t SPCR, SPSR = _BV(SPIF), SPDR;
+volatile uint8_t UBRR0H, UBRR0L, UCSR0A = _BV(UDRE0) | _BV(TXC0), UCSR0B, UCSR0C, UDR0;
+
+//EEPROM reached through plain addresses, erased
+static uint8_t gHostEeprom[E2END + 1] = {[0 ... E2END] = 0xff};
+
+void *host_eeprom_address(const void *address)
+{
+  uintptr_t value = (uintptr_t)address;
+  return value <= E2END ? &gHostEeprom[value] : (void *)address;
+}
@@ -0,0 +1,36 @@
+#include "uart.h"
+
+#include <stdio.h>
+
+//Host stand-in for uart.c, transmitted bytes go to gHostUartOutput (discarded while 0)
+
+FILE *gHostUartOutput = 0;
+
+void uart_init(void)
+{
+}
+
+void uart_disable(void)
+{
+  if (gHostUartOutput)
+    fflush(gHostUartOutput);
+}
+
+void uart_write(uint8_t data)
+{
+  if (gHostUartOutput)
+    fputc(data, gHostUartOutput);
+}
+
+void uart_write_string(const char *text)
+{
+  while (*text)
+    uart_write(*text++);
+}
+
+void uart_write_hex(uint8_t value)
+{
+  static const char kHexDigits[] = "0123456789abcdef";
+  uart_write(kHexDigits[value >> 4]);
+  uart_write(kHexDigits[value & 0x0f]);
+}
@@ -0,0 +1,10 @@
+#ifndef BOILPOWER_HOST_UTIL_ATOMIC_H_
+#define BOILPOWER_HOST_UTIL_ATOMIC_H_
+
+//Host stand-in for <util/atomic.h>, the harness is single threaded
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(type) for (int hostAtomicOnce = 1; hostAtomicOnce; hostAtomicOnce = 0)
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef BOILPOWER_HOST_UTIL_DELAY_H_
+#define BOILPOWER_HOST_UTIL_DELAY_H_
+
+//Host stand-in for <util/delay.h>, delays take no time
+
+#define _delay_us(us)
+#define _delay_ms(ms)
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef BOILPOWER_HOST_UTIL_SETBAUD_H_
+#define BOILPOWER_HOST_UTIL_SETBAUD_H_
+
+//Host stand-in for <util/setbaud.h>
+
+#define UBRR_VALUE  ((F_CPU + 8UL * BAUD) / (16UL * BAUD) - 1UL)
+#define UBRRH_VALUE (UBRR_VALUE >> 8)
+#define UBRRL_VALUE (UBRR_VALUE & 0xff)
+#define USE_2X 0
+
+#endif
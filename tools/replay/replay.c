@@ -0,0 +1,342 @@
+//Host-side trace replay for BoilPower
+//
+//Reads a trace dump ("#trace" header followed by "tttt ee dd" lines, see trace_dump())
+//from stdin, feeds the recorded encoder and button inputs back through the firmware UI
+//and PWM logic at accelerated virtual time and diffs the resulting output events
+//(UI states, lock changes, PWM edges, settings writes) against the recorded ones.
+//
+//The trace survives resets, so a dump holds one or more runs. A run starts at its run
+//marker (recorded by ui_init) and ends at the next boot record or at the dump. The replay
+//starts in run mode with the marker at time 0, the marker's settings crc tells whether the
+//replay runs on the same settings. Dumps are taken from setup, so the last run is the one
+//before the reset.
+//
+//Usage: replay [-p period] [-s sensitivity] [-f frequency] [-h hotLock] [-a adaptive] [-r ramp] [-i inrush] [-m mainsHz] [-n run] [-t tolerance] < dump.txt
+//       replay -g [options] < dump.txt > generated.txt
+//Settings default to the firmware defaults, tolerance (ms) defaults to 1.
+//-r sets the ramp limit (percent per period), -i enables the inrush first-cycle policy.
+//Without -m no zero-cross signal is simulated and the firmware runs on the fallback frequency.
+//-n picks the run that many runs before the last one in the dump (default 0).
+//-g runs the firmware from power-up on the inputs of the selected run, resets it and writes
+//the dump the setup menu sends over the UART after the reset.
+//Exit status is 0 when the replay matches the capture, 1 on differences, 2 on errors.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <avr/io.h>
+
+#include "display.h"
+#include "encoder.h"
+#include "hwprofile.h"
+#include "mains.h"
+#include "pwm.h"
+#include "settings.h"
+#include "status.h"
+#include "temperature.h"
+#include "trace.h"
+#include "ui.h"
+#include "watchdog.h"
+
+//Firmware interrupt handlers (plain functions in the host build)
+void TIMER0_COMPA_vect(void);
+void TIMER1_CAPT_vect(void);
+void TIMER1_COMPA_vect(void);
+void ENCODER_PCINT_VECTOR(void);
+
+//Receives the firmware's UART output (host/uart.c)
+extern FILE *gHostUartOutput;
+
+//Timer1 counts per virtual millisecond
+#define REPLAY_TIMER1_PER_MS (F_CPU / MAINS_TIMER_PRESCALER / 1000)
+
+#define REPLAY_MAX_EVENTS 4096
+
+//Generated sessions run on this long past their last input
+#define REPLAY_GENERATE_TAIL 100
+
+struct ReplayEvent {
+  uint32_t time;  //Unwrapped milliseconds since boot
+  uint8_t type;
+  uint8_t data;
+};
+
+struct ReplayLog {
+  struct ReplayEvent events[REPLAY_MAX_EVENTS];
+  unsigned count;
+};
+
+//Last dump in the input as recorded, times are the raw 16 bit timestamps
+static struct TraceEvent gCapture[REPLAY_MAX_EVENTS];
+static unsigned gCaptureCount = 0;
+static uint8_t gCaptureWrapped = 0;
+
+//Selected run, times in ms since its run marker
+static struct ReplayLog gCaptureInputs, gCaptureOutputs, gReplayOutputs;
+
+static const char *kEventNames[] = {"boot", "step", "button", "state", "lock", "pwm", "settings", "freq", "period", "fault", "boil", "run", "tick"};
+
+static const char *replay_event_name(uint8_t type)
+{
+  return type < sizeof(kEventNames) / sizeof(kEventNames[0]) ? kEventNames[type] : "?";
+}
+
+static uint8_t replay_is_input(uint8_t type)
+{
+  return type == kTraceEncoderStep || type == kTraceButton;
+}
+
+static void replay_append(struct ReplayLog *log, uint32_t time, uint8_t type, uint8_t data)
+{
+  if (log->count == REPLAY_MAX_EVENTS) {
+    fprintf(stderr, "replay: too many events\n");
+    exit(2);
+  }
+  log->events[log->count].time = time;
+  log->events[log->count].type = type;
+  log->events[log->count].data = data;
+  ++log->count;
+}
+
+static void replay_read_capture(FILE *input)
+{
+  char line[128];
+  while (fgets(line, sizeof(line), input)) {
+    unsigned raw, type, data, count, wrapped;
+    if (sscanf(line, "#trace %x %x", &count, &wrapped) == 2) {
+      //Only the last dump counts
+      gCaptureCount = 0;
+      gCaptureWrapped = wrapped;
+      continue;
+    }
+    if (sscanf(line, "%x %x %x", &raw, &type, &data) != 3)
+      continue;
+    if (gCaptureCount == REPLAY_MAX_EVENTS) {
+      fprintf(stderr, "replay: too many events\n");
+      exit(2);
+    }
+    gCapture[gCaptureCount].time = raw;
+    gCapture[gCaptureCount].type = type;
+    gCapture[gCaptureCount].data = data;
+    ++gCaptureCount;
+  }
+}
+
+static void replay_select_run(unsigned back)
+{
+  //Run markers from the last one backwards
+  unsigned start = gCaptureCount;
+  for (unsigned i = gCaptureCount; i--; ) {
+    if (gCapture[i].type == kTraceRun && !back--) {
+      start = i;
+      break;
+    }
+  }
+  if (start == gCaptureCount) {
+    if (gCaptureWrapped)
+      fprintf(stderr, "replay: the start of the run was overwritten, nothing to replay\n");
+    else
+      fprintf(stderr, "replay: no run in capture, nothing to replay\n");
+    exit(2);
+  }
+
+  //Recorded times are 16 bit, assume consecutive events are less than 65s apart (see TRACE_TICK_INTERVAL)
+  uint32_t time = 0;
+  uint16_t lastRaw = gCapture[start].time;
+  for (unsigned i = start; i < gCaptureCount && gCapture[i].type != kTraceBoot; ++i) {
+    time += (uint16_t)(gCapture[i].time - lastRaw);
+    lastRaw = gCapture[i].time;
+    replay_append(replay_is_input(gCapture[i].type) ? &gCaptureInputs : &gCaptureOutputs, time, gCapture[i].type, gCapture[i].data);
+  }
+}
+
+static void replay_set_inputs(uint8_t bits)
+{
+  if (PINC == bits)
+    return;
+  PINC = bits;
+  ENCODER_PCINT_VECTOR();
+}
+
+static void replay_apply_input(const struct ReplayEvent *event)
+{
+  uint8_t bits = event->data & kEncoderPinMask;
+  if (event->type == kTraceEncoderStep) {
+    //Steps are recorded on Encoder A rising, make sure the firmware sees A low first
+    replay_set_inputs(PINC & ~kEncoderPinA);
+    replay_set_inputs(bits);
+  } else {
+    //Button edge, keep Encoder A as is to avoid injecting a step
+    replay_set_inputs((bits & ~kEncoderPinA) | (PINC & kEncoderPinA));
+  }
+}
+
+static void replay_collect_outputs(uint32_t now)
+{
+  for (uint8_t i = 0; i < trace_count(); ++i) {
+    struct TraceEvent event;
+    trace_get(i, &event);
+    if (replay_is_input(event.type))
+      continue;
+    replay_append(&gReplayOutputs, now - (uint16_t)((uint16_t)now - event.time), event.type, event.data);
+  }
+  trace_clear();
+}
+
+//Advance Timer1 by one virtual millisecond, firing compare and zero-cross capture events in order
+static void replay_advance_timer1(uint32_t mainsPeriod, uint32_t *nextEdge)
+{
+  uint16_t start = TCNT1;
+  for (uint16_t step = 1; step <= REPLAY_TIMER1_PER_MS; ++step) {
+    TCNT1 = start + step;
+    if (TCNT1 == OCR1A)
+      TIMER1_COMPA_vect();
+    if (mainsPeriod && !--*nextEdge) {
+      ICR1 = TCNT1;
+      TIMER1_CAPT_vect();
+      *nextEdge = mainsPeriod;
+    }
+  }
+}
+
+//Runs the firmware on the selected run's inputs, collecting its output events unless generating
+static void replay_run(struct BoilPowerSettings *settings, uint32_t end, uint8_t mainsHz, uint8_t generate)
+{
+  //Idle inputs: encoder pins and enter (active low) high
+  PINC = kEncoderPinMask;
+
+  //Mirror main() start-up after a power-up, settings are valid so setup is skipped
+  trace_init(kWatchdogResetPowerOn);
+  pwm_init();
+  watchdog_init();
+  status_init();
+  display_init();
+  encoder_init();
+  trace_record(kTraceBoot, kWatchdogResetPowerOn);
+  mains_init(settings->data.frequency);
+  temperature_init();
+  //The captured run starts at its run marker
+  if (!generate)
+    trace_clear();
+  ui_init(settings);
+
+  uint32_t mainsPeriod = mainsHz ? F_CPU / MAINS_TIMER_PRESCALER / mainsHz : 0;
+  uint32_t nextEdge = mainsPeriod;
+
+  unsigned nextInput = 0;
+  for (uint32_t now = 0; now < end; ++now) {
+    while (nextInput < gCaptureInputs.count && gCaptureInputs.events[nextInput].time <= now)
+      replay_apply_input(&gCaptureInputs.events[nextInput++]);
+    ui_update();
+    pwm_update();
+    display_update();
+    trace_update();
+    watchdog_update();
+    if (!generate)
+      replay_collect_outputs(now);
+    TIMER0_COMPA_vect();
+    replay_advance_timer1(mainsPeriod, &nextEdge);
+  }
+}
+
+//Reset the firmware and dump the trace the way the setup menu does after the reset
+static void replay_reset_dump(void)
+{
+  trace_init(_BV(EXTRF));
+  trace_record(kTraceBoot, _BV(EXTRF));
+  trace_dump(0);
+}
+
+static void replay_print(char marker, const struct ReplayEvent *event)
+{
+  printf("%c %8u %-8s %02x\n", marker, (unsigned)event->time, replay_event_name(event->type), event->data);
+}
+
+static unsigned replay_diff(uint32_t tolerance)
+{
+  unsigned differences = 0;
+  unsigned i = 0, j = 0;
+  while (i < gCaptureOutputs.count || j < gReplayOutputs.count) {
+    const struct ReplayEvent *captured = i < gCaptureOutputs.count ? &gCaptureOutputs.events[i] : 0;
+    const struct ReplayEvent *replayed = j < gReplayOutputs.count ? &gReplayOutputs.events[j] : 0;
+    if (captured && replayed && captured->type == replayed->type && captured->data == replayed->data) {
+      uint32_t skew = captured->time > replayed->time ? captured->time - replayed->time : replayed->time - captured->time;
+      if (skew > tolerance) {
+        replay_print('<', captured);
+        replay_print('>', replayed);
+        ++differences;
+      } else {
+        replay_print(' ', captured);
+      }
+      ++i;
+      ++j;
+      continue;
+    }
+    //Report whichever event comes first as missing from the other side
+    if (captured && (!replayed || captured->time <= replayed->time)) {
+      replay_print('-', captured);
+      ++i;
+    } else {
+      replay_print('+', replayed);
+      ++j;
+    }
+    ++differences;
+  }
+  return differences;
+}
+
+int main(int argc, char *argv[])
+{
+  struct BoilPowerSettings settings;
+  memset(&settings, 0, sizeof(settings));
+  settings_init(&settings);
+  uint32_t tolerance = 1;
+  uint8_t mainsHz = 0;
+  unsigned run = 0;
+  uint8_t generate = 0;
+
+  int option;
+  while ((option = getopt(argc, argv, "p:s:f:h:a:r:i:m:n:t:g")) != -1) {
+    switch (option) {
+      case 'p': settings.data.period = atoi(optarg); break;
+      case 's': settings.data.sensitivity = atoi(optarg); break;
+      case 'f': settings.data.frequency = atoi(optarg); break;
+      case 'h': settings.data.hotLock = atoi(optarg); break;
+      case 'a': settings.data.adaptive = atoi(optarg); break;
+      case 'r': settings.data.rampStep = atoi(optarg); break;
+      case 'i': settings.data.inrush = atoi(optarg); break;
+      case 'm': mainsHz = atoi(optarg); break;
+      case 'n': run = atoi(optarg); break;
+      case 't': tolerance = atoi(optarg); break;
+      case 'g': generate = 1; break;
+      default:
+        fprintf(stderr, "usage: %s [-p period] [-s sensitivity] [-f frequency] [-h hotLock] [-a adaptive] [-r ramp] [-i inrush] [-m mainsHz] [-n run] [-t tolerance] < dump.txt\n"
+                        "       %s -g [options] < dump.txt > generated.txt\n", argv[0], argv[0]);
+        return 2;
+    }
+  }
+
+  replay_read_capture(stdin);
+  replay_select_run(run);
+
+  if (generate) {
+    uint32_t end = gCaptureInputs.count ? gCaptureInputs.events[gCaptureInputs.count - 1].time : 0;
+    gHostUartOutput = stdout;
+    replay_run(&settings, end + REPLAY_GENERATE_TAIL, mainsHz, 1);
+    replay_reset_dump();
+    return 0;
+  }
+
+  //Nothing is known after the last captured event (the dump), stop just past it
+  uint32_t end = 0;
+  if (gCaptureInputs.count)
+    end = gCaptureInputs.events[gCaptureInputs.count - 1].time;
+  if (gCaptureOutputs.count && gCaptureOutputs.events[gCaptureOutputs.count - 1].time > end)
+    end = gCaptureOutputs.events[gCaptureOutputs.count - 1].time;
+  replay_run(&settings, end + tolerance + 1, mainsHz, 0);
+  unsigned differences = replay_diff(tolerance);
+  printf("%u captured, %u replayed, %u differences\n", gCaptureOutputs.count, gReplayOutputs.count, differences);
+  return differences ? 1 : 0;
+}
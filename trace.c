@@ -0,0 +1,128 @@
+#include "trace.h"
+
+#include <util/atomic.h> 
+
+#include "display.h" //Provides millis16()
+#include "hwprofile.h"
+#include "uart.h"
+
+//Ring buffer of recorded events, gTraceHead is the next write position
+//Kept across resets so a dump after a reset still shows the run before it
+static struct TraceEvent gTraceBuffer[TRACE_BUFFER_SIZE] __attribute__((section(".noinit")));
+static volatile uint8_t gTraceHead __attribute__((section(".noinit")));
+static volatile uint8_t gTraceCount __attribute__((section(".noinit")));
+static volatile uint8_t gTraceWrapped __attribute__((section(".noinit")));
+static uint16_t gTraceMagic __attribute__((section(".noinit")));
+
+static const uint16_t kTraceMagic = 0x7ace;
+
+//Time of the last recorded event
+static volatile uint16_t gTraceLastTime = 0;
+
+//Recording is suspended while the buffer is being dumped
+static volatile uint8_t gTracePaused = 0;
+
+void trace_init(uint8_t resetFlags)
+{
+  //RAM holds garbage after a power-up, check the indices in case a brownout hit it
+  if ((resetFlags & kWatchdogResetPowerOn) || gTraceMagic != kTraceMagic || gTraceHead >= TRACE_BUFFER_SIZE || gTraceCount > TRACE_BUFFER_SIZE) {
+    trace_clear();
+    gTraceMagic = kTraceMagic;
+  }
+}
+
+void trace_update(void)
+{
+  uint16_t lastTime;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    lastTime = gTraceLastTime;
+  }
+  if ((uint16_t)(millis16() - lastTime) >= TRACE_TICK_INTERVAL)
+    trace_record(kTraceTick, 0);
+}
+
+void trace_record(uint8_t type, uint8_t data)
+{
+  uint16_t timestamp = millis16();
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (!gTracePaused) {
+      struct TraceEvent *event = &gTraceBuffer[gTraceHead];
+      event->time = timestamp;
+      event->type = type;
+      event->data = data;
+      gTraceLastTime = timestamp;
+      gTraceHead = (gTraceHead + 1) & (TRACE_BUFFER_SIZE - 1);
+      if (gTraceCount < TRACE_BUFFER_SIZE)
+        ++gTraceCount;
+      else
+        gTraceWrapped = 1;
+    }
+  }
+}
+
+uint8_t trace_count(void)
+{
+  return gTraceCount;
+}
+
+uint8_t trace_available(void)
+{
+#if HWPROFILE_UART
+  for (uint8_t i = 0; i < gTraceCount; ++i) {
+    struct TraceEvent event;
+    trace_get(i, &event);
+    if (event.type != kTraceBoot)
+      return 1;
+  }
+#endif
+  return 0;
+}
+
+uint8_t trace_wrapped(void)
+{
+  return gTraceWrapped;
+}
+
+void trace_get(uint8_t index, struct TraceEvent *event)
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    *event = gTraceBuffer[(gTraceHead - gTraceCount + index) & (TRACE_BUFFER_SIZE - 1)];
+  }
+}
+
+void trace_clear(void)
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    gTraceHead = 0;
+    gTraceCount = 0;
+    gTraceWrapped = 0;
+  }
+}
+
+void trace_dump(void (*service)(void))
+{
+  //Output format, one event per line (hex): "tttt ee dd"
+  //Header line: "#trace <count> <wrapped>"
+  gTracePaused = 1;
+  uart_init();
+  uart_write_string("#trace ");
+  uart_write_hex(gTraceCount);
+  uart_write(' ');
+  uart_write_hex(gTraceWrapped);
+  uart_write_string("\r\n");
+  for (uint8_t i = 0; i < gTraceCount; ++i) {
+    struct TraceEvent event;
+    trace_get(i, &event);
+    uart_write_hex(event.time >> 8);
+    uart_write_hex(event.time);
+    uart_write(' ');
+    uart_write_hex(event.type);
+    uart_write(' ');
+    uart_write_hex(event.data);
+    uart_write_string("\r\n");
+    if (service)
+      service();
+  }
+  uart_disable();
+  gTracePaused = 0;
+}
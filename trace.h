@@ -0,0 +1,64 @@
+#ifndef BOILPOWER_TRACE_H_
+#define BOILPOWER_TRACE_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+
+#include "hwprofile.h"
+
+//Number of events held in RAM (must be a power of 2)
+#define TRACE_BUFFER_SIZE HWPROFILE_TRACE_SIZE
+
+//A kTraceTick is recorded after this long without events, keeping gaps within the 16 bit timestamps
+#define TRACE_TICK_INTERVAL 60000U
+
+enum TraceEventType {
+  kTraceBoot,         //data: MCUSR reset flags
+  kTraceEncoderStep,  //data: raw encoder pin bits after Encoder A rising
+  kTraceButton,       //data: raw encoder pin bits after Enter change
+  kTraceUiState,      //data: UiState entered
+  kTraceUiLock,       //data: 1 = locked, 0 = unlocked
+  kTracePwm,          //data: 1 = output active, 0 = output inactive
+  kTraceSettings,     //data: settings crc written
+  kTraceFrequency,    //data: mains frequency in Hz applied to PWM timing
+  kTracePwmPeriod,    //data: effective PWM period in mains cycles (saturates at 255)
+  kTraceFault,        //data: WatchdogFault code of the last reset
+  kTraceBoil,         //data: temperature in degrees C when the boil was detected
+  kTraceRun,          //data: settings crc, recorded when run mode starts
+  kTraceTick          //data: 0, recorded by trace_update() when nothing else was
+};
+
+struct TraceEvent {
+  uint16_t time;      //millis16() timestamp
+  uint8_t type;
+  uint8_t data;
+};
+
+//Keep the events of the previous run unless resetFlags show a power-on or the buffer is not valid
+void trace_init(uint8_t resetFlags);
+
+//Record a kTraceTick when no event was recorded for TRACE_TICK_INTERVAL
+void trace_update(void);
+
+//Record an event (safe to call from ISRs)
+void trace_record(uint8_t type, uint8_t data);
+
+//Number of events held, oldest event is index 0
+uint8_t trace_count(void);
+
+//Returns 1 if there is a UART to dump to and anything beyond boot records was captured
+uint8_t trace_available(void);
+
+//Returns 1 if older events were overwritten since last clear
+uint8_t trace_wrapped(void);
+
+//Copy event at index (0 = oldest)
+void trace_get(uint8_t index, struct TraceEvent *event);
+
+//Discard all recorded events
+void trace_clear(void);
+
+//Write all recorded events as text over the UART, service is called between events
+void trace_dump(void (*service)(void));
+
+#endif
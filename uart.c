@@ -0,0 +1,81 @@
+#include "uart.h"
+
+#include "hwprofile.h"
+
+#if HWPROFILE_UART
+
+#define BAUD 9600
+#include <util/setbaud.h>
+
+//Set once a byte has been written since uart_init
+static uint8_t gUartPending = 0;
+
+void uart_init(void)
+{
+  UART_BAUD_HIGH_REG = UBRRH_VALUE;
+  UART_BAUD_LOW_REG = UBRRL_VALUE;
+#if USE_2X
+  UART_STATUS_REG |= kUartDoubleSpeed;
+#else
+  UART_STATUS_REG &= ~kUartDoubleSpeed;
+#endif
+  UART_FORMAT_REG = kUartFormat;
+  UART_CONTROL_REG |= kUartTransmitEnable;
+}
+
+void uart_disable(void)
+{
+  //Wait for the last byte to leave the shift register before releasing TXD
+  if (gUartPending)
+    while (!(UART_STATUS_REG & kUartTransmitComplete));
+  gUartPending = 0;
+  UART_CONTROL_REG &= ~kUartTransmitEnable;
+}
+
+void uart_write(uint8_t data)
+{
+  while (!(UART_STATUS_REG & kUartDataRegisterEmpty));
+  //Clear transmit complete flag (write one), other flags must be written zero
+  UART_STATUS_REG = (UART_STATUS_REG & kUartDoubleSpeed) | kUartTransmitComplete;
+  UART_DATA_REG = data;
+  gUartPending = 1;
+}
+
+void uart_write_string(const char *text)
+{
+  while (*text)
+    uart_write(*text++);
+}
+
+void uart_write_hex(uint8_t value)
+{
+  static const char kHexDigits[] = "0123456789abcdef";
+  uart_write(kHexDigits[value >> 4]);
+  uart_write(kHexDigits[value & 0x0f]);
+}
+
+#else
+
+//No UART on this board, output is discarded
+
+void uart_init(void)
+{
+}
+
+void uart_disable(void)
+{
+}
+
+void uart_write(uint8_t data)
+{
+}
+
+void uart_write_string(const char *text)
+{
+}
+
+void uart_write_hex(uint8_t value)
+{
+}
+
+#endif
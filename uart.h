@@ -0,0 +1,22 @@
+#ifndef BOILPOWER_UART_H_
+#define BOILPOWER_UART_H_
+
+#include <stdint.h>
+#include <avr/io.h> 
+
+//Enable the transmitter (takes over TXD from the display until uart_disable)
+void uart_init(void);
+
+//Release TXD back to normal port operation
+void uart_disable(void);
+
+//Blocking single byte transmit
+void uart_write(uint8_t data);
+
+//Write a null terminated string
+void uart_write_string(const char *text);
+
+//Write value as two hex digits
+void uart_write_hex(uint8_t value);
+
+#endif
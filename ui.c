@@ -1,14 +1,39 @@
 #include "ui.h"
 
+#include <stddef.h>
 #include <stdint.h>
-#include <string.h>
+#include <avr/pgmspace.h>
 
+#include "boil.h"
 #include "calcs.h"
 #include "display.h"
 #include "encoder.h"
+#include "eventlog.h"
 #include "hwprofile.h"
+#include "mains.h"
 #include "pwm.h"
 #include "status.h"
+#include "temperature.h"
+#include "trace.h"
+#include "watchdog.h"
+
+enum UiMenuFormat {
+  kUiFormatNumber,   //Value as is
+  kUiFormatTenths,   //Value in tenths (ie 1.0)
+  kUiFormatOnOff,    //0 = OFF, 1 = ON
+  kUiFormatConfirm,  //No field, runs update after a yES confirmation
+  kUiFormatAction    //No field, runs update right away
+};
+
+struct UiMenuItem {
+  const char *title;   //Flash string, titles longer than the display scroll
+  uint8_t offset;      //Field offset in BoilPowerSettingsData
+  uint8_t minValue;
+  uint8_t maxValue;
+  uint8_t format;      //UiMenuFormat
+  uint8_t (*update)(struct BoilPowerSettings *settings); //Dependent recalculation or action, returns 1 to leave the menu
+  uint8_t (*guard)(void); //Optional, item hidden while it returns 0
+};
 
 enum UiState {
   kUiStateOff,
@@ -21,45 +46,116 @@ enum UiState {
 
 void ui_state_enter(enum UiState state);
 void ui_update_value(uint8_t value);
+uint8_t ui_setpoint(uint8_t index);
+void ui_apply_frequency(uint8_t frequency);
+uint8_t ui_range(struct BoilPowerSettings *settings, uint8_t frequency);
 void ui_lock(void);
 void ui_unlock(void);
-uint8_t ui_setup_period(struct BoilPowerSettings *settings);
-uint8_t ui_setup_sensitivity(struct BoilPowerSettings *settings);
-uint8_t ui_setup_frequency(struct BoilPowerSettings *settings);
-uint8_t ui_setup_user1(struct BoilPowerSettings *settings);
-uint8_t ui_setup_user2(struct BoilPowerSettings *settings);
-uint8_t ui_setup_user3(struct BoilPowerSettings *settings);
-uint8_t ui_setup_hotlock(struct BoilPowerSettings *settings);
-uint8_t ui_setup_reset(struct BoilPowerSettings *settings);
-uint8_t ui_setup_save(struct BoilPowerSettings *settings);
-uint16_t ui_get_value(uint16_t value, uint8_t minValue, uint8_t maxValue, uint8_t decimalPosition, uint16_t (*calc_function)(uint8_t, uint8_t));
-uint8_t ui_get_yes_no(uint8_t value, char displayYes[], char displayNo[]);
-
-struct menuItem {
-  char title[4];
-  uint8_t (*menuFunc)(struct BoilPowerSettings*);
+void ui_boil(void);
+void ui_service(void);
+char ui_hex_digit(uint8_t digit);
+uint8_t ui_setup_item(struct BoilPowerSettings *settings, const struct UiMenuItem *item);
+uint8_t ui_recalc_sensitivity(struct BoilPowerSettings *settings);
+uint8_t ui_recalc_frequency(struct BoilPowerSettings *settings);
+uint8_t ui_apply_display(struct BoilPowerSettings *settings);
+uint8_t ui_action_reset(struct BoilPowerSettings *settings);
+uint8_t ui_action_trace(struct BoilPowerSettings *settings);
+uint8_t ui_action_log(struct BoilPowerSettings *settings);
+void ui_show_log_record(uint8_t index);
+uint8_t ui_action_save(struct BoilPowerSettings *settings);
+uint16_t ui_get_value(uint16_t value, uint8_t minValue, uint8_t maxValue, uint8_t decimalPosition);
+uint8_t ui_get_yes_no(uint8_t value, const char *displayYes, const char *displayNo);
+
+//Menu titles, kept in flash
+static const char kUiTitlePeriod[] PROGMEM = "PEriod";
+static const char kUiTitleSensitivity[] PROGMEM = "SEnSitivity";
+static const char kUiTitleFrequency[] PROGMEM = "FrEquEncy";
+static const char kUiTitleUser1[] PROGMEM = "USEr 1";
+static const char kUiTitleUser2[] PROGMEM = "USEr 2";
+static const char kUiTitleUser3[] PROGMEM = "USEr 3";
+static const char kUiTitleHotLock[] PROGMEM = "Hot LocK";
+static const char kUiTitleAdaptive[] PROGMEM = "AdAPtivE";
+static const char kUiTitleRamp[] PROGMEM = "rAMP";
+static const char kUiTitleInrush[] PROGMEM = "InruSH";
+static const char kUiTitleBoil[] PROGMEM = "boIL";
+static const char kUiTitleAltitude[] PROGMEM = "ALtitudE";
+static const char kUiTitleBrightness[] PROGMEM = "brIGHt";
+static const char kUiTitleDimLevel[] PROGMEM = "dIM LEVEL";
+static const char kUiTitleDimTimeout[] PROGMEM = "dIM tIME";
+static const char kUiTitleReset[] PROGMEM = "rESEt";
+static const char kUiTitleTrace[] PROGMEM = "trAcE";
+static const char kUiTitleLog[] PROGMEM = "LoG";
+static const char kUiTitleSave[] PROGMEM = "SAVE";
+
+#define UI_FIELD(field) offsetof(struct BoilPowerSettingsData, field)
+
+static const struct UiMenuItem kUiMenu[] PROGMEM = {
+  //Title               Field                      Min  Max           Format            Update                 Guard
+  {kUiTitlePeriod,      UI_FIELD(period),          1,   255,          kUiFormatTenths,  ui_recalc_sensitivity, 0},
+  {kUiTitleSensitivity, UI_FIELD(sensitivity),     1,   255,          kUiFormatNumber,  ui_recalc_sensitivity, 0},
+  {kUiTitleFrequency,   UI_FIELD(frequency),       1,   255,          kUiFormatNumber,  ui_recalc_frequency,   0},
+  {kUiTitleUser1,       UI_FIELD(userSetpoint[0]), 0,   100,          kUiFormatNumber,  0,                     0},
+  {kUiTitleUser2,       UI_FIELD(userSetpoint[1]), 0,   100,          kUiFormatNumber,  0,                     0},
+  {kUiTitleUser3,       UI_FIELD(userSetpoint[2]), 0,   100,          kUiFormatNumber,  0,                     0},
+  {kUiTitleHotLock,     UI_FIELD(hotLock),         0,   1,            kUiFormatOnOff,   0,                     0},
+  {kUiTitleAdaptive,    UI_FIELD(adaptive),        0,   1,            kUiFormatOnOff,   0,                     0},
+  {kUiTitleRamp,        UI_FIELD(rampStep),        0,   100,          kUiFormatNumber,  0,                     0},
+  {kUiTitleInrush,      UI_FIELD(inrush),          0,   1,            kUiFormatOnOff,   0,                     0},
+  {kUiTitleBoil,        UI_FIELD(boilLevel),       0,   3,            kUiFormatNumber,  0,                     0},
+  {kUiTitleAltitude,    UI_FIELD(altitude),        0,   60,           kUiFormatTenths,  0,                     0},
+  {kUiTitleBrightness,  UI_FIELD(brightness),      1,   DISPLAY_BRIGHTNESS_MAX, kUiFormatNumber, ui_apply_display, 0},
+  {kUiTitleDimLevel,    UI_FIELD(dimLevel),        1,   DISPLAY_BRIGHTNESS_MAX, kUiFormatNumber, ui_apply_display, 0},
+  {kUiTitleDimTimeout,  UI_FIELD(dimTimeout),      0,   255,          kUiFormatNumber,  ui_apply_display,      0},
+  {kUiTitleReset,       0,                         0,   0,            kUiFormatConfirm, ui_action_reset,       0},
+  {kUiTitleTrace,       0,                         0,   0,            kUiFormatAction,  ui_action_trace,       trace_available},
+  {kUiTitleLog,         0,                         0,   0,            kUiFormatAction,  ui_action_log,         eventlog_count},
+  {kUiTitleSave,        0,                         0,   0,            kUiFormatAction,  ui_action_save,        0}
 };
 
-static const struct menuItem kSettingsMenu[] = {
-  {"Prd", ui_setup_period},
-  {"SEN", ui_setup_sensitivity},
-  {"Frq", ui_setup_frequency},
-  {" U1", ui_setup_user1},
-  {" U2", ui_setup_user2},
-  {" U3", ui_setup_user3},
-  {"Hot", ui_setup_hotlock},
-  {"rSt", ui_setup_reset},
-  {"SEt", ui_setup_save}
+#define UI_MENU_ITEMS (sizeof(kUiMenu) / sizeof(kUiMenu[0]))
+
+//Event log names by EventLogType
+#define UI_LOG_NAME_LENGTH 6
+static const char kUiLogNames[kEventLogNumTypes][UI_LOG_NAME_LENGTH] PROGMEM = {
+  "boot", "FAULt", "LoSS", "SYnC", "SEt", "LocK", "ProbE", "boIL"
 };
 
+//Time a fault code is shown at start-up unless Enter is pressed (ms)
+static const uint16_t kUiFaultDisplayTime = 5000;
+
+//Time the boil message is shown before the value returns (ms)
+static const uint16_t kUiBoilDisplayTime = 5000;
+
+//Time a mains lock or loss must hold before it is applied and written to the event log (ms)
+static const uint16_t kUiMainsSettleTime = 10000;
+
 static struct BoilPowerSettings *gUiSettings;
 static enum UiState gUiState = kUiStateOff;
 static uint8_t gUiLocked = 1;
 
+//Mains frequency the encoder range and PWM period are currently based on
+static uint8_t gUiFrequency = 0;
+static uint8_t gUiRange = 0;
+static uint8_t gUiMainsLocked = 0;
+
+//Mains lock state last applied and logged, and when the pending change started
+static uint8_t gUiMainsSettled = 0;
+static uint16_t gUiMainsChangeTime = 0;
+
+//Boil message shown since gUiBoilTime
+static uint8_t gUiBoilMessage = 0;
+static uint16_t gUiBoilTime = 0;
+
 void ui_init(struct BoilPowerSettings *settings)
 {
   gUiSettings = settings;
-  encoder_set_limits(0, calcs_range(gUiSettings->data.period, gUiSettings->data.frequency, gUiSettings->data.sensitivity));
+  //Start of the session a replay picks up from, with the settings it ran on
+  trace_record(kTraceRun, settings_crc(&gUiSettings->data));
+  ui_apply_display(gUiSettings);
+  pwm_set_adaptive(gUiSettings->data.adaptive);
+  pwm_set_ramp(gUiSettings->data.rampStep, gUiSettings->data.inrush);
+  ui_apply_frequency(mains_frequency());
+  boil_init(gUiSettings->data.altitude);
   encoder_set_value(0);
   ui_state_enter(kUiStateOff);
   ui_lock();
@@ -67,6 +163,37 @@ void ui_init(struct BoilPowerSettings *settings)
 
 void ui_update()
 {
+  watchdog_checkin(kWatchdogUi);
+
+  //Follow the measured mains frequency
+  uint8_t frequency = mains_frequency();
+  uint8_t mainsLocked = mains_locked();
+  if (mainsLocked != gUiMainsLocked) {
+    gUiMainsLocked = mainsLocked;
+    gUiMainsChangeTime = millis16();
+  }
+  //Only a lock state that has held is applied and logged, a noisy zero-cross input neither wears the EEPROM nor rescales the output
+  if (mainsLocked != gUiMainsSettled && (uint16_t)(millis16() - gUiMainsChangeTime) >= kUiMainsSettleTime) {
+    gUiMainsSettled = mainsLocked;
+    //A loss is logged with the frequency that was locked
+    eventlog_record(mainsLocked ? kEventLogMainsLocked : kEventLogMainsLost, mainsLocked ? frequency : gUiFrequency);
+    if (frequency != gUiFrequency)
+      ui_apply_frequency(frequency);
+  } else if (gUiMainsSettled && mainsLocked && (frequency > gUiFrequency + 1 || frequency + 1 < gUiFrequency)) {
+    //1Hz hysteresis, rounding jitter of the measurement is ignored
+    ui_apply_frequency(frequency);
+  }
+
+  //Boil detection from the probe's heating rate
+  if (temperature_update() && gUiSettings->data.boilLevel) {
+    if (boil_update(temperature_value()))
+      ui_boil();
+    else if (!boil_detected())
+      status_clear(kStatusBoil);
+  }
+  if (gUiBoilMessage && (uint16_t)(millis16() - gUiBoilTime) >= kUiBoilDisplayTime)
+    ui_update_value(encoder_value());
+
   if (gUiLocked) {
     if (encoder_cancel()) 
       ui_unlock();
@@ -76,29 +203,36 @@ void ui_update()
       ui_lock();
     if (encoder_ok())
       ui_state_enter(gUiState + 1);
-    if(encoder_changed())
-      ui_update_value(encoder_value());
+    if(encoder_changed()) {
+      uint8_t value = encoder_value();
+      //Turning the encoder in a user state adjusts that setpoint
+      if (gUiState >= kUiStateU1 && gUiState <= kUiStateU3)
+        gUiSettings->data.userSetpoint[gUiState - kUiStateU1] = calcs_value_percent(value, gUiRange);
+      ui_update_value(value);
+    }
   }
 }
 
 void ui_state_enter(enum UiState state)
 {
   gUiState = state;
+  trace_record(kTraceUiState, gUiState);
   switch (gUiState) {
   case kUiStateOff:
     ui_update_value(0);
     encoder_set_value(0);
     break;
   case kUiStateOn:
-    ui_update_value(encoder_maximum());
-    encoder_set_value(encoder_maximum());
+    ui_update_value(gUiRange);
+    encoder_set_value(gUiRange);
     break;
   case kUiStateU1:
   case kUiStateU2:
   case kUiStateU3:
     if (gUiSettings->data.userSetpoint[gUiState - kUiStateU1]) {
-      ui_update_value(gUiSettings->data.userSetpoint[gUiState - kUiStateU1]);
-      encoder_set_value(gUiSettings->data.userSetpoint[gUiState - kUiStateU1]);
+      uint8_t value = ui_setpoint(gUiState - kUiStateU1);
+      ui_update_value(value);
+      encoder_set_value(value);
     } else {
       ui_state_enter(gUiState + 1);
     }
@@ -111,16 +245,49 @@ void ui_state_enter(enum UiState state)
 
 void ui_update_value(uint8_t value)
 {
-  if (gUiState >= kUiStateU1 && gUiState <= kUiStateU3)
-    gUiSettings->data.userSetpoint[gUiState - kUiStateU1] = value;
-  uint8_t maximum = encoder_maximum();
+  if (gUiBoilMessage) {
+    gUiBoilMessage = 0;
+    display_set_blink(0);
+  }
   if (!value)
-    display_write_string("Off");
-  else if (value == maximum)
-    display_write_string(" On");
+    display_write_string_P(PSTR("Off"));
+  else if (value >= gUiRange)
+    display_write_string_P(PSTR(" On"));
   else
-    display_write_number(calcs_pwm_percent(value, maximum), 1);
-  pwm_set_level(calcs_pwm_time(pwm_period(), value, maximum));
+    display_write_number(calcs_pwm_percent(value, gUiRange), 1);
+  pwm_set_level(calcs_pwm_cycles(pwm_period(), value, gUiRange));
+}
+
+uint8_t ui_setpoint(uint8_t index)
+{
+  //Setpoints are stored in percent, scaled to the range of the applied frequency
+  return calcs_percent_value(gUiSettings->data.userSetpoint[index], gUiRange);
+}
+
+void ui_apply_frequency(uint8_t frequency)
+{
+  uint8_t range = ui_range(gUiSettings, frequency);
+  uint8_t value = encoder_value();
+  //Keep the applied power when the range changes
+  if (gUiRange)
+    value = ((uint16_t)value * range + gUiRange / 2) / gUiRange;
+  gUiFrequency = frequency;
+  gUiRange = range;
+  pwm_set_period(calcs_period_cycles(gUiSettings->data.period, frequency));
+  if (gUiLocked)
+    encoder_set_limits(value, value);
+  else
+    encoder_set_limits(0, range);
+  encoder_set_value(value);
+  ui_update_value(value);
+  trace_record(kTraceFrequency, frequency);
+}
+
+uint8_t ui_range(struct BoilPowerSettings *settings, uint8_t frequency)
+{
+  //Raise sensitivity as needed to keep the range within 255 at this frequency
+  uint8_t sensitivity = calcs_minimum_sensitivity(settings->data.sensitivity, settings->data.period, frequency);
+  return calcs_range(settings->data.period, frequency, sensitivity);
 }
 
 void ui_lock()
@@ -132,14 +299,70 @@ void ui_lock()
   encoder_set_limits(value, value);
   status_set(kStatusLock);
   gUiLocked = 1;
+  trace_record(kTraceUiLock, 1);
+  eventlog_record(kEventLogLock, 1);
 }
 
 void ui_unlock()
 {
   //Restore normal encoder range
-  encoder_set_limits(0, calcs_range(gUiSettings->data.period, gUiSettings->data.frequency, gUiSettings->data.sensitivity));
+  encoder_set_limits(0, gUiRange);
   status_clear(kStatusLock);
   gUiLocked = 0;
+  trace_record(kTraceUiLock, 0);
+  eventlog_record(kEventLogLock, 0);
+}
+
+void ui_boil(void)
+{
+  uint8_t level = gUiSettings->data.boilLevel;
+  uint8_t setpoint = ui_setpoint(level - 1);
+  uint8_t celsius = temperature_value() >> 4;
+
+  status_set(kStatusBoil);
+  trace_record(kTraceBoil, celsius);
+  eventlog_record(kEventLogBoil, celsius);
+
+  //Maintenance level only ever lowers the output
+  if (setpoint && setpoint < encoder_value()) {
+    if (gUiLocked)
+      encoder_set_limits(setpoint, setpoint);
+    ui_state_enter(kUiStateU1 + level - 1);
+  }
+
+  display_write_string_P(PSTR("boIL"));
+  display_set_blink(DISPLAY_BLINK_ALL);
+  gUiBoilMessage = 1;
+  gUiBoilTime = millis16();
+}
+
+void ui_service(void)
+{
+  //Blocking UI loops keep the output, display and watchdog serviced
+  pwm_update();
+  display_update();
+  eventlog_update();
+  trace_update();
+  temperature_update(); //Probe conversions keep sensing checked in without mains edges
+  watchdog_checkin(kWatchdogUi);
+  watchdog_update();
+}
+
+void ui_show_fault(uint8_t fault)
+{
+  //F and the fault code in hex (ie F12 = watchdog reset, UI did not check in)
+  char text[4] = {'F', ui_hex_digit(fault >> 4), ui_hex_digit(fault & 0x0f), 0};
+  display_write_string(text);
+  display_set_blink(DISPLAY_BLINK_ALL);
+  uint16_t start = millis16();
+  while ((uint16_t)(millis16() - start) < kUiFaultDisplayTime && !encoder_ok())
+    ui_service();
+  display_set_blink(0);
+}
+
+char ui_hex_digit(uint8_t digit)
+{
+  return digit < 10 ? '0' + digit : 'A' + digit - 10;
 }
 
 void ui_setup(struct BoilPowerSettings *settings)
@@ -149,138 +372,227 @@ void ui_setup(struct BoilPowerSettings *settings)
     kMenuStateUpdate,
     kMenuStateReady
   } menuState = kMenuStateInit;
-  
+
   uint8_t menuPos = 0;
-  
+  uint8_t visibleItems[UI_MENU_ITEMS];
+  uint8_t visibleCount = 0;
+  struct UiMenuItem item;
+
   while(1) {
     switch (menuState) {
       case kMenuStateInit:
-        encoder_set_limits(0, sizeof(kSettingsMenu) / sizeof(kSettingsMenu[0]) - 1);
+        //List the items whose guard allows them
+        visibleCount = 0;
+        for (uint8_t i = 0; i < UI_MENU_ITEMS; ++i) {
+          //Copied as bytes like the items themselves, no object to function pointer conversion
+          uint8_t (*guard)(void);
+          memcpy_P(&guard, &kUiMenu[i].guard, sizeof(guard));
+          if (!guard || guard())
+            visibleItems[visibleCount++] = i;
+        }
+        if (menuPos >= visibleCount)
+          menuPos = visibleCount - 1;
+        encoder_set_limits(0, visibleCount - 1);
         encoder_set_value(menuPos);
-        
+
       case kMenuStateUpdate:
-        display_write_string(kSettingsMenu[menuPos].title);
+        memcpy_P(&item, &kUiMenu[visibleItems[menuPos]], sizeof(item));
+        display_write_string_P(item.title);
         menuState = kMenuStateReady;
-        
+
       case kMenuStateReady:
         if(encoder_changed()) {
           menuPos = encoder_value();
           menuState = kMenuStateUpdate;
         }
         if(encoder_ok()) {
-          if(kSettingsMenu[menuPos].menuFunc(settings))
+          if(ui_setup_item(settings, &item))
             return; //Exit Signal
           menuState = kMenuStateInit;
         }
         encoder_cancel(); //Dummy Check to Clear Cancel Status
+        ui_service();
     }
   }
 }
 
-uint8_t ui_setup_period(struct BoilPowerSettings *settings)
+uint8_t ui_setup_item(struct BoilPowerSettings *settings, const struct UiMenuItem *item)
 {
-  settings->data.period = ui_get_value(settings->data.period, 1, 255, 1, 0);
-  settings->data.sensitivity = calcs_minimum_sensitivity(settings->data.sensitivity, settings->data.period, settings->data.frequency);
-  return 0;
+  uint8_t *field = (uint8_t *)&settings->data + item->offset;
+
+  switch (item->format) {
+    case kUiFormatNumber:
+      *field = ui_get_value(*field, item->minValue, item->maxValue, 0);
+      break;
+    case kUiFormatTenths:
+      *field = ui_get_value(*field, item->minValue, item->maxValue, 1);
+      break;
+    case kUiFormatOnOff:
+      *field = ui_get_yes_no(*field, PSTR(" ON"), PSTR("OFF"));
+      break;
+    case kUiFormatConfirm:
+      if (!ui_get_yes_no(0, PSTR("yES"), PSTR(" No")))
+        return 0;
+      break;
+    default:
+      break;
+  }
+  //Dependent recalculation or the item's action
+  return item->update ? item->update(settings) : 0;
 }
 
-uint8_t ui_setup_sensitivity(struct BoilPowerSettings *settings)
+uint8_t ui_recalc_sensitivity(struct BoilPowerSettings *settings)
 {
-  settings->data.sensitivity = ui_get_value(settings->data.sensitivity, calcs_minimum_sensitivity(1, settings->data.period, settings->data.frequency), 255, 0, 0);
+  //Keep the encoder range within 255 for the period and the measured frequency, the fallback while unlocked
+  uint8_t frequency = mains_locked() ? mains_frequency() : settings->data.frequency;
+  settings->data.sensitivity = calcs_minimum_sensitivity(settings->data.sensitivity, settings->data.period, frequency);
   return 0;
 }
 
-uint8_t ui_setup_frequency(struct BoilPowerSettings *settings)
+uint8_t ui_recalc_frequency(struct BoilPowerSettings *settings)
 {
-  settings->data.frequency = ui_get_value(settings->data.frequency, 1, 255, 0, 0);
-  settings->data.sensitivity = calcs_minimum_sensitivity(settings->data.sensitivity, settings->data.period, settings->data.frequency);
-  return 0;
+  mains_set_fallback(settings->data.frequency);
+  return ui_recalc_sensitivity(settings);
 }
 
-uint8_t ui_setup_user1(struct BoilPowerSettings *settings)
+uint8_t ui_apply_display(struct BoilPowerSettings *settings)
 {
-  settings->data.userSetpoint[0] = ui_get_value(settings->data.userSetpoint[0], 0, calcs_range(settings->data.period, settings->data.frequency, settings->data.sensitivity), 1, calcs_pwm_percent);
+  //Applied right away so a changed brightness shows while still in the menu
+  display_set_brightness(settings->data.brightness);
+  display_set_auto_dim(settings->data.dimLevel, settings->data.dimTimeout);
   return 0;
 }
 
-uint8_t ui_setup_user2(struct BoilPowerSettings *settings)
+uint8_t ui_action_reset(struct BoilPowerSettings *settings)
 {
-  settings->data.userSetpoint[1] = ui_get_value(settings->data.userSetpoint[1], 0, calcs_range(settings->data.period, settings->data.frequency, settings->data.sensitivity), 1, calcs_pwm_percent);
+  settings->header.size = 0; //Invalidate header
+  settings_init(settings); //Initialize Settings
   return 0;
 }
 
-uint8_t ui_setup_user3(struct BoilPowerSettings *settings)
+uint8_t ui_action_trace(struct BoilPowerSettings *settings)
 {
-  settings->data.userSetpoint[2] = ui_get_value(settings->data.userSetpoint[2], 0, calcs_range(settings->data.period, settings->data.frequency, settings->data.sensitivity), 1, calcs_pwm_percent);
+  //Dump the event trace over serial
+  display_write_spinner();
+  trace_dump(ui_service);
   return 0;
 }
 
-uint8_t ui_setup_hotlock(struct BoilPowerSettings *settings)
+uint8_t ui_action_log(struct BoilPowerSettings *settings)
 {
-  settings->data.hotLock = ui_get_yes_no(settings->data.hotLock, " ON", "OFF");
+  //Browse records newest first, Enter dumps the log over serial, Cancel leaves
+  encoder_set_limits(0, eventlog_count() - 1);
+  encoder_set_value(0);
+  uint8_t updateRequired = 1;
+  while (1) {
+    if (encoder_changed())
+      updateRequired = 1;
+    if (updateRequired) {
+      ui_show_log_record(encoder_value());
+      updateRequired = 0;
+    }
+    ui_service();
+    if (encoder_ok()) {
+      display_write_spinner();
+      eventlog_dump(ui_service);
+      break;
+    }
+    if (encoder_cancel())
+      break;
+  }
   return 0;
 }
 
-uint8_t ui_setup_reset(struct BoilPowerSettings *settings)
+void ui_show_log_record(uint8_t index)
 {
-  if(ui_get_yes_no(0, "yES", " No")) {
-    settings->header.size = 0; //Invalidate header
-    settings_init(settings); //Initialize Settings
+  //Name, data in hex and seconds since boot (ie "LocK 01 1234")
+  struct EventLogRecord record;
+  if (!eventlog_get(index, &record) || record.type >= kEventLogNumTypes) {
+    display_write_string_P(PSTR("---"));
+    return;
   }
-  return 0;
+  char text[DISPLAY_TEXT_LENGTH + 1];
+  uint8_t length = 0;
+  char c;
+  while (length < UI_LOG_NAME_LENGTH && (c = pgm_read_byte(&kUiLogNames[record.type][length])))
+    text[length++] = c;
+  text[length++] = ' ';
+  text[length++] = ui_hex_digit(record.data >> 4);
+  text[length++] = ui_hex_digit(record.data & 0x0f);
+  text[length++] = ' ';
+  uint8_t digits = 0;
+  char reversed[5];
+  do {
+    reversed[digits++] = '0' + record.time % 10;
+    record.time /= 10;
+  } while (record.time);
+  while (digits)
+    text[length++] = reversed[--digits];
+  text[length] = 0;
+  display_write_string(text);
 }
 
-uint8_t ui_setup_save(struct BoilPowerSettings *settings)
+uint8_t ui_action_save(struct BoilPowerSettings *settings)
 {
   //Flag for Exit, Settings saved in main() initialization
   return 1;
 }
 
-uint16_t ui_get_value(uint16_t value, uint8_t minValue, uint8_t maxValue, uint8_t decimalPosition, uint16_t (*calc_function)(uint8_t, uint8_t))
+uint16_t ui_get_value(uint16_t value, uint8_t minValue, uint8_t maxValue, uint8_t decimalPosition)
 {
   encoder_set_limits(minValue, maxValue);
   encoder_set_value(value);
-  uint16_t displayValue = 0, workingValue = 0;
+  uint16_t workingValue = 0;
   uint8_t updateRequired = 1;
   
+  //Blink the value being edited
+  display_set_blink(DISPLAY_BLINK_ALL);
   while (1) {
     if (encoder_changed())
       updateRequired = 1;
     if (updateRequired) {
       workingValue = encoder_value();
-      displayValue = calc_function ? (*calc_function)(workingValue, maxValue) : workingValue;
-      if (displayValue > DISPLAY_MAX_NUMBER)
-        display_write_string(" ON");
-      else
-        display_write_number(displayValue, decimalPosition);
+      display_write_number(workingValue, decimalPosition);
       updateRequired = 0;
     }
+    ui_service();
     if(encoder_ok())
-      return workingValue;
-    if(encoder_cancel())
-      return value;
+      break;
+    if(encoder_cancel()) {
+      workingValue = value;
+      break;
+    }
   }
+  display_set_blink(0);
+  return workingValue;
 }
 
-uint8_t ui_get_yes_no(uint8_t value, char displayYes[], char displayNo[])
+uint8_t ui_get_yes_no(uint8_t value, const char *displayYes, const char *displayNo)
 {
   encoder_set_limits(0, 1);
   encoder_set_value(value ? 1 : 0);
   uint8_t updateRequired = 1;
+  uint8_t result = 0;
   
+  display_set_blink(DISPLAY_BLINK_ALL);
   while (1) {
     if (encoder_changed())
       updateRequired = 1;
     if (updateRequired) {
       if(encoder_value())
-        display_write_string(displayYes);
+        display_write_string_P(displayYes);
       else
-        display_write_string(displayNo);
+        display_write_string_P(displayNo);
       updateRequired = 0;
     }
-    if(encoder_ok())
-      return encoder_value();
+    ui_service();
+    if(encoder_ok()) {
+      result = encoder_value();
+      break;
+    }
     if(encoder_cancel())
-      return 0;
+      break;
   }
+  display_set_blink(0);
+  return result;
 }
\ No newline at end of file
@@ -7,4 +7,7 @@ void ui_setup(struct BoilPowerSettings *settings);
 void ui_init(struct BoilPowerSettings *settings);
 void ui_update(void);
 
+//Show a watchdog fault code until timeout or Enter, output stays off
+void ui_show_fault(uint8_t fault);
+
 #endif
\ No newline at end of file
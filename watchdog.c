@@ -0,0 +1,93 @@
+#include "watchdog.h"
+
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include <avr/wdt.h>
+#include <util/atomic.h>
+
+#include "hwprofile.h"
+
+//Kept across resets, set before the watchdog reset fires
+static uint8_t gWatchdogResetFlags __attribute__((section(".noinit")));
+static volatile uint8_t gWatchdogMissing __attribute__((section(".noinit")));
+
+static volatile uint8_t gWatchdogAlive = 0;
+static uint8_t gWatchdogFault = kWatchdogFaultNone;
+
+uint16_t EEMEM eepromFaultCount;
+
+void watchdog_early_init(void) __attribute__((naked, used, section(".init3")));
+
+//Runs straight after reset, before .data/.bss setup and main()
+void watchdog_early_init(void)
+{
+  //Heater output off first, a watchdog reset leaves the watchdog running
+  PWM_OUTPUT_REG &= ~kPwmPinMask;
+  PWM_DIR_REG |= kPwmPinMask;
+  gWatchdogResetFlags = WATCHDOG_RESET_STATUS_REG;
+  WATCHDOG_RESET_STATUS_REG = 0;
+  wdt_disable();
+}
+
+void watchdog_init(void)
+{
+  uint8_t missing = gWatchdogMissing & kWatchdogAll;
+  gWatchdogMissing = 0;
+  if (gWatchdogResetFlags & kWatchdogResetWatchdog)
+    gWatchdogFault = kWatchdogFaultWatchdog | missing;
+  else if ((gWatchdogResetFlags & (kWatchdogResetBrownout | kWatchdogResetPowerOn)) == kWatchdogResetBrownout)
+    gWatchdogFault = kWatchdogFaultBrownout; //A cold power-up sets BORF along with PORF
+
+  if (gWatchdogFault) {
+    uint16_t count = watchdog_fault_count();
+    if (count < 0xfffe)
+      eeprom_update_word(&eepromFaultCount, count + 1);
+  }
+
+  //Interrupt on the first timeout to record who is late, reset on the second
+  wdt_enable(WATCHDOG_TIMEOUT);
+  WATCHDOG_CONTROL_REG |= kWatchdogInterrupt;
+  sei();
+}
+
+void watchdog_checkin(uint8_t subsystem)
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    gWatchdogAlive |= subsystem;
+  }
+}
+
+void watchdog_update(void)
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (gWatchdogAlive == kWatchdogAll) {
+      gWatchdogAlive = 0;
+      wdt_reset();
+      //Re-arm the interrupt if a late feed let it fire
+      WATCHDOG_CONTROL_REG |= kWatchdogInterrupt;
+    }
+  }
+}
+
+uint8_t watchdog_reset_flags(void)
+{
+  return gWatchdogResetFlags;
+}
+
+uint8_t watchdog_fault(void)
+{
+  return gWatchdogFault;
+}
+
+uint16_t watchdog_fault_count(void)
+{
+  uint16_t count = eeprom_read_word(&eepromFaultCount);
+  return count == 0xffff ? 0 : count; //Erased EEPROM
+}
+
+ISR(WDT_vect)
+{
+  //Reset follows on the next timeout unless fed, keep the output off meanwhile
+  PWM_OUTPUT_REG &= ~kPwmPinMask;
+  gWatchdogMissing = ~gWatchdogAlive & kWatchdogAll;
+}
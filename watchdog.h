@@ -0,0 +1,40 @@
+#ifndef BOILPOWER_WATCHDOG_H_
+#define BOILPOWER_WATCHDOG_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+
+//Subsystems that must check in between watchdog feeds
+enum WatchdogSubsystem {
+  kWatchdogPwm = 0x01,      //pwm_update()
+  kWatchdogUi = 0x02,       //ui_update() and the blocking setup loops
+  kWatchdogSensing = 0x04,  //Accepted zero-cross edge or completed probe conversion
+  kWatchdogAll = 0x07
+};
+
+//Fault codes, watchdog faults carry the subsystems that failed to check in (0 = unknown)
+enum WatchdogFault {
+  kWatchdogFaultNone = 0x00,
+  kWatchdogFaultWatchdog = 0x10,
+  kWatchdogFaultBrownout = 0x20
+};
+
+//Start supervision, counts a fault left by the previous reset
+void watchdog_init(void);
+
+//Mark a subsystem alive (safe to call from ISRs)
+void watchdog_checkin(uint8_t subsystem);
+
+//Feed the watchdog once every subsystem has checked in, call from the main loop
+void watchdog_update(void);
+
+//MCUSR reset flags of the last reset
+uint8_t watchdog_reset_flags(void);
+
+//Fault code of the last reset
+uint8_t watchdog_fault(void);
+
+//Faults counted since the EEPROM was erased
+uint16_t watchdog_fault_count(void);
+
+#endif